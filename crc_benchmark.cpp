@@ -0,0 +1,82 @@
+//
+// host-port of examples/debug/CRC-Comparison: throughput of every CRC-kernel (see CRC_KERNEL in config)
+// build the target crc_benchmark and run it, all kernels have to agree on the result
+//
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+#include "src/OneWireHub.h"
+#include "src/OneWireHub_crc.h"
+
+using namespace std;
+
+constexpr uint8_t  li[] = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed "
+        "do eiusmod tempor incididunt ut labore et dolore magna "
+        "aliqua. Ut enim ad minim veniam, quis nostrud exercitation "
+        "ullamco laboris nisi ut aliquip ex ea commodo consequat. Duis "
+        "aute irure dolor";
+constexpr uint8_t  li_size      = sizeof(li);
+constexpr uint32_t BENCH_LOOPS  = 10000; // keeps the 32bit cycle-counter from wrapping around
+
+template <typename T>
+using kernel_t = T (*)(const uint8_t address[], const uint8_t length, T crc);
+
+template <typename T>
+T benchmark(const char * const name, const kernel_t<T> kernel)
+{
+    const T crc = kernel(li, li_size, 0); // also warm up, slice4 builds its tables here
+    volatile T sink = 0;                  // keeps the compiler from removing the loop
+
+    const auto   time_start  = chrono::steady_clock::now();
+    const cycle_t cycle_start = cycleCount();
+    for (uint32_t i = 0; i < BENCH_LOOPS; ++i)
+    {
+        sink = kernel(li, li_size, sink);
+    }
+    const cycle_t cycle_stop  = cycleCount();
+    const auto   time_stop   = chrono::steady_clock::now();
+
+    const double seconds  = chrono::duration<double>(time_stop - time_start).count();
+    const double bytes    = double(li_size) * BENCH_LOOPS;
+
+    cout << "  " << setw(14) << left << name
+         << setw(10) << right << fixed << setprecision(1) << (bytes / seconds / 1e6) << " MB/s"
+         << setw(10) << setprecision(2) << (double(cycle_t(cycle_stop - cycle_start)) / bytes) << " cycles/byte"
+         << "   got 0x" << hex << uppercase << unsigned(crc) << dec << endl;
+    return crc;
+}
+
+int main()
+{
+    cout << "CRC-ing " << unsigned(li_size) << " bytes " << BENCH_LOOPS << " times" << endl;
+
+    cout << "CRC8 (0x8C):" << endl;
+    const uint8_t crc8_reference = benchmark<uint8_t>("bitwise", crc8Bitwise);
+    bool crc8_agree = true;
+    crc8_agree &= (benchmark<uint8_t>("nibble", crc8Nibble) == crc8_reference);
+    crc8_agree &= (benchmark<uint8_t>("table", crc8Table)   == crc8_reference);
+    crc8_agree &= (benchmark<uint8_t>("slice4", crc8Slice4) == crc8_reference);
+
+    cout << "CRC16 (0xA001):" << endl;
+    const uint16_t crc16_reference = benchmark<uint16_t>("bitwise", crc16Bitwise);
+    bool crc16_agree = true;
+    crc16_agree &= (benchmark<uint16_t>("nibble", crc16Nibble) == crc16_reference);
+    crc16_agree &= (benchmark<uint16_t>("table", crc16Table)   == crc16_reference);
+    crc16_agree &= (benchmark<uint16_t>("slice4", crc16Slice4) == crc16_reference);
+
+    // the bit-step of send() / recv() has to match the kernels too
+    uint16_t crc16_steps = 0;
+    for (uint8_t i = 0; i < li_size; ++i)
+    {
+        for (uint8_t j = 0; j < 8; ++j) crc16_steps = crc16Step(crc16_steps, static_cast<bool>((li[i] >> j) & 0x01));
+    }
+    crc16_agree &= (crc16_steps == crc16Bitwise(li, li_size, 0));
+
+    if (!(crc8_agree && crc16_agree))
+    {
+        cout << "kernels disagree!" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -59,6 +59,15 @@ void loop()
     // following function must be called periodically
     hub.poll();
 
+    // react to writes of the master right away, only filled with EVENT_ENABLE in src/OneWireHub_config.h
+    DeviceEvent event;
+    while (hub.popEvent(event))
+    {
+        if (event.source != &ds2413) continue;
+        Serial.print("master wrote latch 0x");
+        Serial.println(event.value, HEX);
+    }
+
     // Blink triggers the state-change
     if (blinking())
     {
@@ -69,4 +69,7 @@ void loop()
 {
     // following function must be called periodically
     hub.poll();
+
+    // recalculate page-crcs after writes of the master, so the next readout sends them right away
+    ds2423.updateCRC();
 } 
\ No newline at end of file
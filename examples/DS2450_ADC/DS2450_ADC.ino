@@ -51,6 +51,9 @@ void loop()
     // following function must be called periodically
     hub.poll();
 
+    // recalculate page-crcs after writes of the master, so the next readout sends them right away
+    ds2450.updateCRC();
+
     // Blink triggers the state-change
     if (blinking())
     {
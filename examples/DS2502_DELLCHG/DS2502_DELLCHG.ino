@@ -52,4 +52,8 @@ void loop()
     // following function must be called periodically
     hub.poll();
 
+    // recalculate page-crcs after writes of the master, so the next readout sends them right away
+    dellCHa.updateCRC();
+    dellCHb.updateCRC();
+
 }
\ No newline at end of file
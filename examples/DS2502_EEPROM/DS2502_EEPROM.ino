@@ -13,8 +13,8 @@ constexpr uint8_t pin_onewire   { 8 };
 
 auto hub        = OneWireHub(pin_onewire);
 auto ds2502     = DS2502( DS2502::family_code, 0x00, 0xA0, 0x02, 0x25, 0xDA, 0x00 );
-auto ds2501a    = DS2502( 0x91, 0x00, 0xA0, 0x01, 0x25, 0xDA, 0x00 );
-auto ds2501b    = DS2502( 0x11, 0x00, 0xB0, 0x02, 0x25, 0xDA, 0x00 );
+auto ds2501a    = DS2501( 0x91, 0x00, 0xA0, 0x01, 0x25, 0xDA, 0x00 );
+auto ds2501b    = DS2501( 0x11, 0x00, 0xB0, 0x02, 0x25, 0xDA, 0x00 );
 
 void setup()
 {
@@ -60,4 +60,9 @@ void loop()
 {
     // following function must be called periodically
     hub.poll();
+
+    // recalculate page-crcs after writes of the master, so the next readout sends them right away
+    ds2502.updateCRC();
+    ds2501a.updateCRC();
+    ds2501b.updateCRC();
 }
@@ -14,8 +14,8 @@ constexpr uint8_t pin_onewire   { 8 };
 
 auto hub        = OneWireHub(pin_onewire);
 
-auto ds2503     = DS2506( 0x13, 0x00, 0x00, 0x03, 0x25, 0xDA, 0x00 );
-auto ds2505     = DS2506( 0x0B, 0x00, 0x00, 0x05, 0x25, 0xDA, 0x00 );
+auto ds2503     = DS2503( DS2503::family_code, 0x00, 0x00, 0x03, 0x25, 0xDA, 0x00 );
+auto ds2505     = DS2505( DS2505::family_code, 0x00, 0x00, 0x05, 0x25, 0xDA, 0x00 );
 auto ds2506     = DS2506( 0x0F, 0x00, 0x00, 0x06, 0x25, 0xDA, 0x00 );
 
 
@@ -76,4 +76,9 @@ void loop()
     // following function must be called periodically
     hub.poll();
 
+    // recalculate page-crcs after writes of the master, so the next readout sends them right away
+    ds2503.updateCRC();
+    ds2505.updateCRC();
+    ds2506.updateCRC();
+
 }
\ No newline at end of file
@@ -20,6 +20,9 @@
  *       - takes from 5.1 to 7.0 µs/byte dependant from array-length
  *    - Var1 is slower, but can be fragmented in 8 equal parts
  *       - ~0.9 µs per Bit-Step for Var1C
+ *
+ *    the variants live on as CRC-kernels in src/OneWireHub_crc.cpp (select with CRC_KERNEL in config),
+ *    crc_benchmark.cpp in the root-folder compares their throughput on the host (cmake-target crc_benchmark)
  */
 
 #include <util/crc16.h>
@@ -0,0 +1,55 @@
+/*
+ *    Example-Code for the diagnostic slave - the master can read the health of the hub over the bus
+ *
+ *      --> activate STATS_ENABLE (and optional PROFILE_ENABLE) in /src/OneWireHub_config.h
+ *
+ *      --> the master reads the memory with READ MEMORY (0xAA, TA1, TA2) like on a DS2450,
+ *          every page (32 byte) is followed by the inverted crc16
+ *
+ *      --> memory map (little endian):
+ *          page 0: version, features, slave count, slave limit, last error, 3x reserved,
+ *                  uptime [s], refresh-count, resets, rom-commands, searches, errors (32 bit each)
+ *          page 1: 16 bit counter per error (see Error in OneWireHub.h)
+ *          page 2: 32 bit minimum margin per slot-type [loops], 16 bit 1%-percentile per slot-type
+ *          page 3+: ROM of every slave-position, empty positions read as zero
+ *
+ *      --> the snapshot is only refreshed in loop(), so the master always reads consistent values
+ */
+
+#include "OneWireHub.h"
+#include "DS18B20.h"  // Digital Thermometer, 12bit
+#include "HubDiag.h"  // Diagnostic slave
+
+constexpr uint8_t pin_onewire   { 8 };
+
+auto hub     = OneWireHub(pin_onewire);
+
+auto ds18b20 = DS18B20(DS18B20::family_code, 0x00, 0x02, 0x0B, 0x08, 0x01, 0x0D);    // Digital Thermometer
+auto hubdiag = HubDiag(HubDiag::family_code, 0x00, 0x00, 0xD1, 0xA6, 0x00, 0x00);    // Diagnostic slave
+
+void setup()
+{
+    Serial.begin(115200);
+    Serial.println("OneWire-Hub Diagnostic Slave");
+    Serial.flush();
+
+    hub.attach(ds18b20);
+    hub.attach(hubdiag);
+
+    if (!STATS_ENABLE) Serial.println("STATS_ENABLE is not set in OneWireHub_config.h");
+};
+
+void loop()
+{
+    // following function must be called periodically
+    hub.poll();
+
+    constexpr  uint32_t interval    = 1000;         // interval at which to refresh the snapshot (milliseconds)
+    static uint32_t nextMillis  = millis();
+
+    if (millis() > nextMillis)
+    {
+        nextMillis += interval;
+        hubdiag.refresh(hub); // never call it during bus-activity (poll())
+    };
+}
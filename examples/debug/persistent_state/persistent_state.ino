@@ -0,0 +1,69 @@
+/*
+ *    Example-Code that keeps the state of the slaves in the eeprom of the mcu, it survives a reboot
+ *
+ *      --> activate PERSIST_ENABLE in /src/OneWireHub_config.h
+ *
+ *      --> the DS18B20 keeps TH, TL and config (COPY SCRATCHPAD 0x48, RECALL E2 0xB8),
+ *          the DS2423 keeps its counters and the first two pages of memory
+ *
+ *      --> changed blocks of 8 byte get appended to a log in the eeprom, only from loop() and never during bus-activity,
+ *          the log is a ring, so the writes spread over the whole eeprom (wear-leveling)
+ */
+
+#include <EEPROM.h>
+
+#include "OneWireHub.h"
+#include "OneWireHub_persist.h"
+#include "DS18B20.h"  // Digital Thermometer, 12bit
+#include "DS2423.h"   // 4kb 1-Wire RAM with Counter
+
+constexpr uint8_t pin_onewire   { 8 };
+
+class EepromStore : public PersistStore
+{
+public:
+
+    uint16_t getSize(void) const { return EEPROM.length(); };
+    uint8_t  read(const uint16_t address) const { return EEPROM.read(address); };
+    void     write(const uint16_t address, const uint8_t value) { EEPROM.update(address, value); }; // skips unchanged bytes
+};
+
+auto hub     = OneWireHub(pin_onewire);
+
+auto ds18b20 = DS18B20(DS18B20::family_code, 0x00, 0x02, 0x0B, 0x08, 0x01, 0x0D);    // Digital Thermometer
+auto ds2423  = DS2423(DS2423::family_code, 0x00, 0x00, 0x23, 0x24, 0xDA, 0x00);      // RAM with Counter
+
+EepromStore eeprom;
+PersistLog  persist(eeprom);
+
+void setup()
+{
+    Serial.begin(115200);
+    Serial.println("OneWire-Hub Persistent State");
+    Serial.flush();
+
+    hub.attach(ds18b20);
+    hub.attach(ds2423);
+
+    // keep the same order on every boot, the records are identified by their position
+    persist.attach(ds18b20);
+    if (!persist.attach(ds2423, 16 + 64)) // counters and page 0 & 1, the whole memory would not fit into 1kb eeprom
+    {
+        Serial.print("ds2423 does not fit, blocks left: ");
+        Serial.println(persist.getBlocksFree());
+    };
+
+    Serial.print("restored blocks: ");
+    Serial.println(persist.restore());
+    Serial.print("counter 0: ");
+    Serial.println(ds2423.getCounter(0));
+};
+
+void loop()
+{
+    // following function must be called periodically
+    hub.poll();
+
+    // one block per loop keeps the delay short: writing a record takes up to 50ms on an atmega328, the hub does not answer meanwhile
+    persist.flush(1);
+};
@@ -0,0 +1,48 @@
+/*
+ *    Test-Code for the timing-profiler - shows how much margin the hub has left in each slot-type
+ *
+ *      --> activate PROFILE_ENABLE and USE_SERIAL_DEBUG in /src/OneWireHub_config.h
+ *
+ *      --> let the master do its usual work (search, read memory, ...), the profile is printed every 10s
+ *
+ *      --> a margin near zero means the hub arrived (nearly) too late for the slot,
+ *          the busy paths (crc, duty()) before that slot are too slow for this µC/clock
+ */
+
+#include "OneWireHub.h"
+#include "DS18B20.h"  // Digital Thermometer, 12bit
+#include "DS2433.h"   // 4Kb 1-Wire EEPROM
+
+constexpr uint8_t pin_onewire   { 8 };
+
+auto hub     = OneWireHub(pin_onewire);
+
+auto ds18b20 = DS18B20(DS18B20::family_code, 0x00, 0x02, 0x0B, 0x08, 0x01, 0x0D);    // Digital Thermometer
+auto ds2433  = DS2433(DS2433::family_code, 0x00, 0x00, 0x33, 0x24, 0xDA, 0x00);      // 4Kb 1-Wire EEPROM
+
+void setup()
+{
+    Serial.begin(115200);
+    Serial.println("OneWire-Hub Timing-Profiler");
+    Serial.flush();
+
+    hub.attach(ds18b20);
+    hub.attach(ds2433);
+
+    if (!PROFILE_ENABLE) Serial.println("PROFILE_ENABLE is not set in OneWireHub_config.h");
+};
+
+void loop()
+{
+    // following function must be called periodically
+    hub.poll();
+
+    constexpr  uint32_t interval    = 10000;        // interval at which to print the profile (milliseconds)
+    static uint32_t nextMillis  = millis();
+
+    if (millis() > nextMillis)
+    {
+        nextMillis += interval;
+        hub.printProfile(); // serial output can interfere with the bus, so do it rarely
+    };
+}
@@ -0,0 +1,270 @@
+//
+// host-check of the optional features: page-pool, redirection, persist-log, write-journal, snapshots and the topology-parser
+// the target feature_check switches the features on (ONEWIREHUB_FEATURE_CHECK, see config), run it or ctest, returns 1 if a check fails
+//
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "src/OneWireHub.h"
+#include "src/OneWireHub_persist.h"
+#include "src/OneWireHub_topology.h"
+#include "src/DS18B20.h"
+#include "src/DS2433.h"
+#include "src/DS2506.h"
+
+using namespace std;
+
+// eeprom in RAM, a write-budget lets a flush() stop in the middle of a record like a power-loss would
+class RamStore : public PersistStore
+{
+private:
+
+    vector<uint8_t> memory;
+    uint32_t        budget;
+
+public:
+
+    RamStore(const uint16_t size, const uint8_t value) : memory(size, value), budget(0xFFFFFFFF) {};
+
+    uint16_t getSize(void) const                            { return static_cast<uint16_t>(memory.size()); };
+    uint8_t  read(const uint16_t address) const             { return memory[address]; };
+    void     write(const uint16_t address, const uint8_t value)
+    {
+        if (memory[address] == value) return; // unchanged bytes cost no wear
+        if (budget == 0) return;
+        budget--;
+        memory[address] = value;
+    };
+
+    void setBudget(const uint32_t writes) { budget = writes; };
+};
+
+static uint8_t failures = 0;
+
+static void check(const bool condition, const char * const name)
+{
+    cout << (condition ? "ok     " : "FAILED ") << name << endl;
+    if (!condition) failures++;
+};
+
+// the pool hands out PAGE_POOL_SIZE pages, every further page is refused and reported as write-protected
+static void checkPoolExhaustion(void)
+{
+    auto device = DS2506(DS2506::family_code, 0x00, 0x00, 0x06, 0x25, 0xDA, 0x01);
+    const uint8_t data[4] = { 0x11, 0x22, 0x33, 0x44 };
+
+    bool written = true;
+    for (uint16_t page = 0; page < PAGE_POOL_SIZE; ++page) written &= device.writeMemory(data, sizeof(data), page * 32);
+    check(written && (device.getPoolUsed() == PAGE_POOL_SIZE), "pool takes one page per written page");
+
+    const uint16_t page_full = 100;
+    check(!device.writeMemory(data, sizeof(data), page_full * 32), "write to a new page fails with an exhausted pool");
+
+    uint8_t memory[4];
+    device.readMemory(memory, sizeof(memory), page_full * 32);
+    check((memory[0] == 0xFF) && (memory[3] == 0xFF), "refused page stays erased");
+    check((device.readStatus(page_full / 8) & (uint8_t(1) << (page_full & 7))) == 0, "refused page reads as write-protected");
+
+    const uint8_t update[1] = { 0x01 };
+    check(device.writeMemory(update, sizeof(update), 1 * 32), "pooled page stays writable");
+};
+
+// chains resolve to their end, a loop keeps every page of it (and pages leading into it) in place
+static void checkRedirectionCycle(void)
+{
+    uint8_t status[8];
+    memset(status, 0xFF, sizeof(status));               // no redirection
+    status[1] = static_cast<uint8_t>(~2);               // 1 -> 2 -> 3
+    status[2] = static_cast<uint8_t>(~3);
+    status[4] = static_cast<uint8_t>(~5);               // 4 -> 5 -> 4
+    status[5] = static_cast<uint8_t>(~4);
+    status[6] = static_cast<uint8_t>(~4);               // 6 -> loop
+
+    PageRedirection<8> redirection;
+    redirection.update(status);
+
+    check((redirection.getPage(1) == 3) && (redirection.getPage(2) == 3) && (redirection.getPage(3) == 3), "chain resolves to its last page");
+    check((redirection.getPage(4) == 4) && (redirection.getPage(5) == 5), "pages of a loop stay in place");
+    check(redirection.getPage(6) == 6, "page leading into a loop stays in place");
+    check(redirection.getPage(0) == 0, "page without redirection stays in place");
+
+    auto device = DS2506(DS2506::family_code, 0x00, 0x00, 0x06, 0x25, 0xDA, 0x02);
+    check(device.setPageRedirection(4, 5) && device.setPageRedirection(5, 4), "device accepts a loop of redirections");
+    check(device.getPageRedirection(4) == 5, "device reports the first hop of a loop");
+};
+
+// a flush() that stops in the middle of a record leaves the older record of the block valid
+static void checkPersistTornWrite(void)
+{
+    RamStore store(512, 0xFF);
+    const uint8_t first[16]  = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+    const uint8_t second[16] = { 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF, 0xB0 };
+
+    {
+        auto device = DS2433(DS2433::family_code, 0x00, 0x00, 0x33, 0x24, 0xDA, 0x01);
+        PersistLog log(store);
+        log.attach(device, sizeof(first));
+        log.restore(); // finds the end of the empty log
+        device.writeMemory(first, sizeof(first), 0);
+        log.flush(2);
+
+        device.writeMemory(second, sizeof(second), 0);
+        store.setBudget(7); // key, sequence and one data byte of the first block
+        log.flush(2);
+        store.setBudget(0xFFFFFFFF);
+    }
+
+    auto device = DS2433(DS2433::family_code, 0x00, 0x00, 0x33, 0x24, 0xDA, 0x01);
+    PersistLog log(store);
+    log.attach(device, sizeof(first));
+    const uint16_t blocks = log.restore();
+
+    uint8_t memory[16];
+    device.readMemory(memory, sizeof(memory), 0);
+    check((blocks == 2) && (memcmp(memory, first, sizeof(memory)) == 0), "restore after a torn write loads the older records");
+};
+
+// erased and zeroed stores hold no record, restore() leaves the slaves untouched
+static void checkPersistEmptyStore(void)
+{
+    const uint8_t values[2] = { 0xFF, 0x00 };
+    for (uint8_t value : values)
+    {
+        RamStore store(512, value);
+        auto device = DS2433(DS2433::family_code, 0x00, 0x00, 0x33, 0x24, 0xDA, 0x02);
+        const uint8_t data[4] = { 0x5A, 0x5A, 0x5A, 0x5A };
+        device.writeMemory(data, sizeof(data), 0);
+
+        PersistLog log(store);
+        log.attach(device, 16);
+        const uint16_t blocks = log.restore();
+
+        uint8_t memory[4];
+        device.readMemory(memory, sizeof(memory), 0);
+        check((blocks == 0) && (memcmp(memory, data, sizeof(memory)) == 0), (value == 0) ? "zeroed store restores nothing" : "erased store restores nothing");
+    };
+};
+
+// a record survives popJournal(), pack and unpack and gets applied to a standby with the same slaves
+static void checkJournalRoundTrip(void)
+{
+    OneWireHub hub_active(0);
+    OneWireHub hub_standby(0);
+    auto device_active  = DS2433(DS2433::family_code, 0x00, 0x00, 0x33, 0x24, 0xDA, 0x03);
+    auto device_standby = DS2433(DS2433::family_code, 0x00, 0x00, 0x33, 0x24, 0xDA, 0x03);
+    hub_active.attach(device_active);
+    hub_standby.attach(device_standby);
+
+    const uint8_t data[5] = { 0xDE, 0xAD, 0xBE, 0xEF, 0x42 };
+    hub_active.pushJournal(device_active, 0x55, 0x0123, data, sizeof(data)); // copy scratchpad
+
+    JournalRecord record;
+    check(hub_active.popJournal(record), "journal holds the record");
+    JournalRecord empty;
+    check(!hub_active.popJournal(empty), "journal is empty after popJournal()");
+
+    uint8_t buffer[7 + HUB_ARENA_SIZE];
+    const uint8_t size = OneWireHub::packJournal(record, buffer);
+    check(size == (7 + sizeof(data)), "packed record has header and data");
+    JournalRecord copy;
+    check(OneWireHub::unpackJournal(buffer, size - 1, copy) == 0, "truncated record gets rejected");
+    check(OneWireHub::unpackJournal(buffer, size, copy) == size, "unpack consumes the whole record");
+    check((copy.slave == record.slave) && (copy.command == 0x55) && (copy.sequence == record.sequence) && (copy.address == 0x0123)
+          && (copy.length == sizeof(data)) && (memcmp(copy.data, data, sizeof(data)) == 0), "unpacked record equals the pushed one");
+
+    check(hub_standby.replayJournal(copy), "standby accepts the record");
+    uint8_t memory[5];
+    device_standby.readMemory(memory, sizeof(memory), 0x0123);
+    check(memcmp(memory, data, sizeof(memory)) == 0, "standby holds the written bytes");
+
+    copy.slave = 5;
+    check(!hub_standby.replayJournal(copy), "record of a missing slave gets rejected");
+};
+
+// loadSnapshot() refuses foreign or damaged buffers and leaves the hub untouched
+static void checkSnapshotRejection(void)
+{
+    OneWireHub hub(0);
+    auto sensor = DS18B20(DS18B20::family_code, 0x00, 0x00, 0xB2, 0x18, 0xDA, 0x01);
+    auto memory = DS2433(DS2433::family_code, 0x00, 0x00, 0x33, 0x24, 0xDA, 0x04);
+    hub.attach(sensor);
+    hub.attach(memory);
+    sensor.setTemperature(int8_t(30));
+
+    vector<uint8_t> buffer(hub.getSnapshotSize());
+    const uint32_t size = hub.saveSnapshot(buffer.data(), static_cast<uint32_t>(buffer.size()));
+    check((size != 0) && (size == buffer.size()), "snapshot fits getSnapshotSize()");
+
+    OneWireHub fork_hub(0);
+    auto fork_sensor = DS18B20(DS18B20::family_code, 0x00, 0x00, 0xB2, 0x18, 0xDA, 0x01);
+    auto fork_memory = DS2433(DS2433::family_code, 0x00, 0x00, 0x33, 0x24, 0xDA, 0x04);
+    fork_hub.attach(fork_sensor);
+    fork_hub.attach(fork_memory);
+    fork_sensor.setTemperature(int8_t(20));
+
+    vector<uint8_t> damaged(buffer);
+    damaged[size / 2] ^= 0x01;
+    check(!fork_hub.loadSnapshot(damaged.data(), size), "damaged snapshot gets rejected");
+
+    damaged = buffer;
+    damaged[4]++;
+    check(!fork_hub.loadSnapshot(damaged.data(), size), "snapshot of another version gets rejected");
+    check(!fork_hub.loadSnapshot(buffer.data(), size - 1), "truncated snapshot gets rejected");
+
+    OneWireHub other_hub(0);
+    auto other_sensor = DS18B20(DS18B20::family_code, 0x00, 0x00, 0xB2, 0x18, 0xDA, 0x02);
+    auto other_memory = DS2433(DS2433::family_code, 0x00, 0x00, 0x33, 0x24, 0xDA, 0x04);
+    other_hub.attach(other_sensor);
+    other_hub.attach(other_memory);
+    check(!other_hub.loadSnapshot(buffer.data(), size), "snapshot of other slaves gets rejected");
+
+    check(fork_sensor.getTemperature() == 20, "rejected snapshots leave the slaves untouched");
+    check(fork_hub.loadSnapshot(buffer.data(), size) && (fork_sensor.getTemperature() == 30), "matching snapshot gets loaded");
+};
+
+// parse() stops at the first bad line and reports it, a later parse reuses the arena
+static void checkTopologyErrors(void)
+{
+    static uint8_t arena[16384];
+    Topology topology(arena, sizeof(arena));
+
+    struct { const char * text; uint32_t line; const char * name; } cases[] =
+    {
+        { "hub 2\n28 0D 01 08 0B 02 00 temp=21.5\n",                            0, "valid topology parses" },
+        { "hub\n# comment\n77 0D 01 08 0B 02 00\n",                             3, "unknown family code gets reported" },
+        { "hub\n28 0D 01 0G 0B 02 00\n",                                        2, "bad hex gets reported" },
+        { "hub\n28 0D 01 08 0B 02\n",                                           2, "short id gets reported" },
+        { "hub\n23 0D 01 08 0B 02 00 temp=20\n",                                2, "temp= of a memory-device gets reported" },
+        { "hub\n23 0D 01 08 0B 02 00 mem=0010:\n",                              2, "empty mem= gets reported" },
+        { "hub\n28 0D 01 08 0B 02 00 size=2\n",                                 2, "unknown option gets reported" },
+        { "hub\n01 00 00 00 00 00 01\n01 00 00 00 00 00 02\n01 00 00 00 00 00 03\n01 00 00 00 00 00 04\n"
+          "01 00 00 00 00 00 05\n01 00 00 00 00 00 06\n01 00 00 00 00 00 07\n01 00 00 00 00 00 08\n01 00 00 00 00 00 09\n",
+                                                                                10, "device beyond HUB_SLAVE_LIMIT gets reported" },
+    };
+
+    for (const auto &entry : cases)
+    {
+        const bool parsed = topology.parse(entry.text);
+        check((parsed == (entry.line == 0)) && (topology.getErrorLine() == entry.line), entry.name);
+    };
+
+    check(topology.parse("hub\n28 0D 01 08 0B 02 00\nhub\n23 0D 01 08 0B 02 00 mem=0010:DEADBEEF\n")
+          && (topology.getHubCount() == 2) && (topology.getDeviceCount() == 2), "parse after an error builds the new topology");
+
+    static uint8_t small_arena[64];
+    Topology small(small_arena, sizeof(small_arena));
+    check(!small.parse("hub\n28 0D 01 08 0B 02 00\n") && (small.getErrorLine() != 0), "exhausted arena gets reported");
+};
+
+int main(void)
+{
+    checkPoolExhaustion();
+    checkRedirectionCycle();
+    checkPersistTornWrite();
+    checkPersistEmptyStore();
+    checkJournalRoundTrip();
+    checkSnapshotRejection();
+    checkTopologyErrors();
+    return (failures == 0) ? 0 : 1;
+};
@@ -22,6 +22,10 @@ using namespace std;
 #include "src/DS2502.h"  // 1kb EEPROM
 #include "src/DS2506.h"  // 64kb EEPROM
 #include "src/DS2890.h"  // Single channel digital potentiometer
+#include "src/HubDiag.h" // Diagnostic slave
+
+#include "src/OneWireHub_file.h" // memory-devices in mapped files
+#include "src/OneWireHub_topology.h" // hubs and devices from a topology-file
 
 
 
@@ -44,22 +48,23 @@ auto ds2413   = DS2413( 0x3A, 0x0D, 0x02, 0x04, 0x01, 0x03, 0x00 );    // Work -
 
 auto ds2423   = DS2423( 0x1D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 );    //      - 4kb 1-Wire RAM with Counter
 auto ds2431   = DS2431( 0x2D, 0xE8, 0x9F, 0x90, 0x0E, 0x00, 0x00 );    // Work - 1kb 1-Wire EEPROM
-auto ds2433   = DS2433( 0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 );    //      - 4Kb 1-Wire EEPROM
+auto ds2433   = DS2433Backed( 0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 ); //   - 4Kb 1-Wire EEPROM, memory in a MemoryBackend
 auto ds2438   = DS2438( 0x26, 0x0D, 0x02, 0x04, 0x03, 0x08, 0x00 );    //      - Smart Battery Monitor
 auto ds2450   = DS2450( DS2450::family_code, 0x00, 0x00, 0x50, 0x24, 0xDA, 0x00 ); //      - 4 channel A/D
 auto ds2502   = DS2502( DS2502::family_code, 0x00, 0xA0, 0x02, 0x25, 0xDA, 0x00 );
-auto ds2501a  = DS2502( 0x91, 0x00, 0xA0, 0x01, 0x25, 0xDA, 0x00 );
-auto ds2501b  = DS2502( 0x11, 0x00, 0xB0, 0x02, 0x25, 0xDA, 0x00 );
+auto ds2501a  = DS2501( 0x91, 0x00, 0xA0, 0x01, 0x25, 0xDA, 0x00 );
+auto ds2501b  = DS2501( 0x11, 0x00, 0xB0, 0x02, 0x25, 0xDA, 0x00 );
 
-auto ds2503   = DS2506( 0x13, 0x00, 0x00, 0x03, 0x25, 0xDA, 0x00 );
-auto ds2505   = DS2506( 0x0B, 0x00, 0x00, 0x05, 0x25, 0xDA, 0x00 );
+auto ds2503   = DS2503( 0x13, 0x00, 0x00, 0x03, 0x25, 0xDA, 0x00 );
+auto ds2505   = DS2505( 0x0B, 0x00, 0x00, 0x05, 0x25, 0xDA, 0x00 );
 auto ds2506   = DS2506( 0x0F, 0x00, 0x00, 0x06, 0x25, 0xDA, 0x00 );
 auto ds2890A  = DS2890( 0x2C, 0x0D, 0x02, 0x08, 0x09, 0x00, 0x0A );    // Work - Single channel digital potentiometer
 auto ds2890B  = DS2890( 0x2C, 0x0D, 0x02, 0x08, 0x09, 0x00, 0x0B );
 auto ds2890C  = DS2890( 0x2C, 0x0D, 0x02, 0x08, 0x09, 0x00, 0x0C );
 auto bae910   = BAE910(BAE910::family_code, 0x00, 0x00, 0x10, 0xE9, 0xBA, 0x00);
+auto hubdiag  = HubDiag(HubDiag::family_code, 0x00, 0x00, 0xD1, 0xA6, 0x00, 0x00);
 
-int main()
+int main(int argc, char * argv[])
 {
     cout << "Hello, World!" << endl;
     
@@ -89,18 +94,53 @@ int main()
     hubC.attach(ds2890B);
     hubC.attach(ds2890C);
     hubC.attach(bae910);
+    hubC.attach(hubdiag);
 
 
     ds1822.setTemperature(static_cast<int8_t>(21));
     ds18S20.setTemperature(static_cast<int8_t>(10));
 
+    hubdiag.refresh(hubC);
+
+    // ./OneWireHub dump.bin: the ds2433 works on a dump of a real iButton, without a dump it reads as erased
+    MappedFile  dump;
+    FileBackend dump_backend(dump, 0, 512);
+    if (argc > 1)
+    {
+        if (dump.open(argv[1], 512))    ds2433.setBackend(dump_backend);
+        else                            cout << "dump: can not open " << argv[1] << endl;
+    };
+
+    // ./OneWireHub dump.bin topology.txt: builds the hubs and devices of the file in addition
+    static uint8_t topology_arena[1 << 20];
+    Topology topology(topology_arena, sizeof(topology_arena));
+    if (argc > 2)
+    {
+        if (topology.load(argv[2]))
+        {
+            cout << "topology: " << topology.getHubCount() << " hubs, " << topology.getDeviceCount() << " devices, " << topology.getArenaUsed() << " byte" << endl;
+            for (uint16_t index = 0; index < topology.getHubCount(); ++index) topology.getHub(index)->poll();
+        }
+        else
+        {
+            cout << "topology: error in line " << topology.getErrorLine() << endl;
+        };
+    };
+
     hubA.poll();
     hubB.poll();
     hubC.poll();
 
+    ds2423.updateCRC(); // page-crcs of the memory-devices, outside of bus-activity
+    ds2450.updateCRC();
+    ds2502.updateCRC();
+    ds2506.updateCRC();
+
     if (hubA.hasError()) hubA.printError();
     if (hubB.hasError()) hubB.printError();
     if (hubC.hasError()) hubC.printError();
 
+    dump.sync(); // master-writes land in the mapping, this flushes them in one batch
+
     return 0;
 };
\ No newline at end of file
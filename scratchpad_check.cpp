@@ -0,0 +1,139 @@
+//
+// host-check of the ScratchpadEngine: runs write-, read- and copy-scratchpad against a scripted bus instead of a pin
+// build the target scratchpad_check and run it (or ctest), returns 1 if a check fails
+//
+#include <iostream>
+
+#include "src/OneWireHub.h"
+#include "src/DS2431.h"
+
+using namespace std;
+
+// the master side of one transaction: bytes for recv(), the master resets when it has nothing more to send
+class ScriptHub
+{
+private:
+
+    const uint8_t * script;
+    uint8_t         script_size;
+    uint8_t         position;
+    Error           error;
+
+    bool reset(void)
+    {
+        error = Error::RESET_IN_PROGRESS;
+        return true;
+    };
+
+public:
+
+    ScriptHub(const uint8_t data[], const uint8_t size) : script(data), script_size(size), position(0), error(Error::NO_ERROR) {};
+
+    bool recv(uint8_t address[], const uint8_t data_length = 1)
+    {
+        for (uint8_t i = 0; i < data_length; ++i)
+        {
+            if (position >= script_size) return reset();
+            address[i] = script[position++];
+        };
+        return false;
+    };
+
+    bool recv(uint8_t address[], const uint8_t data_length, uint16_t &crc16)
+    {
+        if (recv(address, data_length)) return true;
+        crc16 = OneWireItem::crc16(address, data_length, crc16);
+        return false;
+    };
+
+    bool send(const uint8_t[], const uint8_t = 1)                   { return (position >= script_size) ? reset() : false; };
+    bool send(const uint8_t address[], const uint8_t data_length, uint16_t &) { return send(address, data_length); };
+    bool sendBit(const bool)                                        { return send(nullptr); };
+
+    Error getError(void) const  { return error; };
+    Error clearError(void)      { const Error previous = error; error = Error::NO_ERROR; return previous; };
+
+    static uint8_t * claimArena(const OneWireItem &owner)   { return OneWireHub::claimArena(owner); };
+    static bool      ownsArena(const OneWireItem &owner)    { return OneWireHub::ownsArena(owner); };
+
+    void pushEvent(const OneWireItem &, const uint16_t, const uint8_t, const uint8_t) { };
+    void pushJournal(const OneWireItem &, const uint8_t, const uint16_t, const uint8_t[], const uint8_t) { };
+};
+
+// friend of the DS2431, runs the engine of the device with its own traits, but on a scripted bus instead of duty()
+class ScratchpadCheck
+{
+public:
+
+    template <typename device_t>
+    static bool write(device_t &device, const uint8_t script[], const uint8_t size)
+    {
+        ScriptHub hub(script, size);
+        return device.scratchpad.write(&hub, device, 0);
+    };
+
+    template <typename device_t>
+    static bool copy(device_t &device, const uint8_t script[], const uint8_t size)
+    {
+        ScriptHub hub(script, size);
+        return device.scratchpad.copy(&hub, device);
+    };
+};
+
+static uint8_t failures = 0;
+
+static void check(const bool condition, const char * const name)
+{
+    cout << (condition ? "ok     " : "FAILED ") << name << endl;
+    if (!condition) failures++;
+};
+
+// an unaligned write of B must not copy the bytes A left in the arena
+static void checkArenaLeak(void)
+{
+    auto device_a = DS2431(DS2431::family_code, 0x00, 0x00, 0x31, 0x24, 0xDA, 0x0A);
+    auto device_b = DS2431(DS2431::family_code, 0x00, 0x00, 0x31, 0x24, 0xDA, 0x0B);
+
+    const uint8_t write_a[] = { 0x00, 0x00, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5 }; // TA, full scratchpad
+    ScratchpadCheck::write(device_a, write_a, sizeof(write_a));
+
+    const uint8_t write_b[] = { 0x05, 0x00, 0x11, 0x22, 0x33 }; // TA 0x0005, bytes 5 to 7
+    ScratchpadCheck::write(device_b, write_b, sizeof(write_b));
+
+    const uint8_t copy_b[] = { 0x05, 0x00, 0x07 }; // TA and ES as authorization
+    ScratchpadCheck::copy(device_b, copy_b, sizeof(copy_b));
+
+    uint8_t memory[8];
+    device_b.readMemory(memory, sizeof(memory), 0);
+    check((memory[5] == 0x11) && (memory[6] == 0x22) && (memory[7] == 0x33), "copy scratchpad writes the received bytes");
+
+    bool leaked = false;
+    for (uint8_t i = 0; i < 5; ++i) leaked |= (memory[i] == 0xA5);
+    check(!leaked, "bytes before TA do not hold the scratchpad of another slave");
+};
+
+// a write-protected page keeps its memory, the traits of the device refuse the copy
+static void checkCopyProtection(void)
+{
+    auto device = DS2431(DS2431::family_code, 0x00, 0x00, 0x31, 0x24, 0xDA, 0x0C);
+    device.setPageProtection(0x20); // page 1
+    uint8_t before[8];
+    device.readMemory(before, sizeof(before), 0x20);
+
+    const uint8_t write[] = { 0x20, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88 };
+    ScratchpadCheck::write(device, write, sizeof(write));
+
+    const uint8_t copy[] = { 0x20, 0x00, 0x07 };
+    ScratchpadCheck::copy(device, copy, sizeof(copy));
+
+    uint8_t memory[8];
+    device.readMemory(memory, sizeof(memory), 0x20);
+    check(memcmp(memory, before, sizeof(memory)) == 0, "copy scratchpad skips a write-protected page");
+};
+
+int main(void)
+{
+    checkArenaLeak();
+    checkCopyProtection();
+    return (failures == 0) ? 0 : 1;
+};
@@ -1,9 +1,19 @@
 #include "BAE910.h"
 
+static constexpr RegisterCommand bae910_commands[] PROGMEM =
+{
+    // cmd, address bytes, mask, first, last, crc
+    { 0x11, 0, 0x0000, 0x00, 0x00, CrcMode::END  }, // READ VERSION
+    { 0x12, 0, 0x0000, 0x00, 0x00, CrcMode::END  }, // READ TYPE
+    { 0x14, 2, 0xFFFF, 0x00, 0x7F, CrcMode::END  }, // READ MEMORY, TA2 has to be zero, followed by the length
+    { 0x15, 2, 0xFFFF, 0x00, 0x7F, CrcMode::END  }, // WRITE MEMORY, same as above
+};
+
 BAE910::BAE910(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
 {
     static_assert(sizeof(memory) < 256,  "Implementation does not cover the whole address-space");
     static_assert(sizeof(sBAE910) <= BAE910_MEMORY_SIZE,  "Memory-Struct is larger than its memory");
+    static_assert(BAE910_SCRATCHPAD_SIZE <= HUB_ARENA_SIZE, "Scratchpad does not fit into the arena of the hub");
 
     // clear memory
     memset(&memory.bytes[0], static_cast<uint8_t>(0x00), BAE910_MEMORY_SIZE);
@@ -11,12 +21,15 @@ BAE910::BAE910(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5,
 
 void BAE910::duty(OneWireHub * const hub)
 {
-    uint8_t  cmd, ta1, ta2, len, ecmd; // command, targetAdress, length and extended command
-    uint16_t crc = 0;
+    uint8_t  ta1, len, ecmd; // targetAdress, length and extended command
+    uint8_t  *scratchpad; // borrowed from the hub, only used during one transaction
+    uint16_t reg_TA, crc = 0;
 
-    if (hub->recv(&cmd,1,crc))  return;
+    RegisterCommand command;
+    if (hub->recvCommand(bae910_commands, sizeof(bae910_commands)/sizeof(RegisterCommand), command, reg_TA, crc)) return;
+    ta1 = uint8_t(reg_TA);
 
-    switch (cmd)
+    switch (command.cmd)
     {
         case 0x11: // READ VERSION
             if (hub->send(&memory.field.SW_VER,1,crc))                return;
@@ -35,13 +48,11 @@ void BAE910::duty(OneWireHub * const hub)
             break;
 
         case 0x14: // READ MEMORY
-            if (hub->recv(&ta1,1,crc))                          return;
-            if (hub->recv(&ta2,1,crc))                          return;
             if (hub->recv(&len,1,crc))                          return;
 
-            if ((ta1 + len > 0x80) || (ta2 > 0))
+            if (ta1 + len > 0x80)
             {
-                hub->raiseSlaveError(cmd);
+                hub->raiseSlaveError(command.cmd);
                 return;
             }
             // reverse byte order
@@ -55,16 +66,15 @@ void BAE910::duty(OneWireHub * const hub)
             break;
 
         case 0x15: // WRITE MEMORY
-            if (hub->recv(&ta1,1,crc))                          return;
-            if (hub->recv(&ta2,1,crc))                          return;
             if (hub->recv(&len,1,crc))                          return;
 
-            if ((len > BAE910_SCRATCHPAD_SIZE) || (ta1 + len > 0x80) || (ta2 > 0))
+            if ((len > BAE910_SCRATCHPAD_SIZE) || (ta1 + len > 0x80))
             {
-                hub->raiseSlaveError(cmd);
+                hub->raiseSlaveError(command.cmd);
                 return;
             }
 
+            scratchpad = hub->claimArena(*this);
             if (hub->recv(scratchpad,len,crc))                  return;
 
             crc = ~crc;
@@ -73,6 +83,8 @@ void BAE910::duty(OneWireHub * const hub)
             if (hub->recv(&ecmd ,1))                             return;
             if (ecmd == 0xBC)
             {
+                hub->pushEvent(*this, ta1, len, scratchpad[0]);
+                hub->pushJournal(*this, 0x15, ta1, scratchpad, len);
                 while (len-- > 0) // reverse byte order
                 {
                     memory.bytes[0x7F - ta1 - len] = scratchpad[len];
@@ -82,7 +94,32 @@ void BAE910::duty(OneWireHub * const hub)
 
 //        case 0x13: // EXTENDED COMMAND
 //        case 0x16: // ERASE EEPROM PAGE (not needed/implemented yet)
-        default:
-            hub->raiseSlaveError(cmd);
     };
 };
+
+#if STATE_ENABLE
+uint16_t BAE910::getStateSize(void) const
+{
+    return BAE910_MEMORY_SIZE;
+};
+
+void BAE910::readState(const uint16_t position, uint8_t destination[], const uint8_t length) const
+{
+    memcpy(destination, &memory.bytes[position], length);
+};
+
+void BAE910::writeState(const uint16_t position, const uint8_t source[], const uint8_t length)
+{
+    memcpy(&memory.bytes[position], source, length);
+};
+#endif
+
+#if JOURNAL_ENABLE
+bool BAE910::replayWrite(const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length)
+{
+    if (command != 0x15)                return false;
+    if ((address + length) > 0x80)      return false;
+    for (uint8_t i = 0; i < length; ++i) memory.bytes[0x7F - address - i] = data[i]; // reverse byte order, like the write
+    return true;
+};
+#endif
@@ -83,7 +83,7 @@ typedef struct
     uint8_t  adcc;
     uint8_t  SW_VER; // 0x00 = corrupted
     uint8_t  BOOTSTRAP_VER;
-} sBAE910;
+} __attribute__((packed)) sBAE910; // packed: 32bit-platforms would pad the uint32-fields and break the byte-layout
 
 typedef union {
     uint8_t bytes[BAE910_MEMORY_SIZE];
@@ -96,7 +96,6 @@ private:
 
 protected:
 
-    uint8_t scratchpad[BAE910_SCRATCHPAD_SIZE];
 
 public:
 
@@ -109,6 +108,16 @@ public:
     void duty(OneWireHub * const hub);
 
     // TODO: can be extended with clearMemory(), writeMemory(), readMemory() similar to ds2506
+
+#if JOURNAL_ENABLE
+    bool     replayWrite(const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length); // write memory (0x15)
+#endif
+
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // the memory
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
 };
 
 #endif
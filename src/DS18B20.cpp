@@ -3,23 +3,33 @@
 
 DS18B20::DS18B20(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
 {
-    scratchpad[0] = 0xA0; // TLSB --> 10 degC as std
-    scratchpad[1] = 0x00; // TMSB
-    scratchpad[2] = 0x4B; // THRE --> Trigger register TH
-    scratchpad[3] = 0x46; // TLRE --> TLow
-    scratchpad[4] = 0x7F; // Conf
+    ds18s20_mode = (ID1 == 0x10); // different tempRegister
+
+    Scratchpad &pad = scratchpad.edit();
+    pad.bytes[0] = ds18s20_mode ? 0xAA : 0x50; // TLSB --> 85 degC after power-up, until the first conversion
+    pad.bytes[1] = ds18s20_mode ? 0x00 : 0x05; // TMSB
+    pad.bytes[2] = 0x4B; // THRE --> Trigger register TH
+    pad.bytes[3] = 0x46; // TLRE --> TLow
+    pad.bytes[4] = 0x7F; // Conf
     // = 0 R1 R0 1 1 1 1 1 --> R=0 9bit .... R=3 12bit
-    scratchpad[5] = 0xFF; // 0xFF
-    scratchpad[6] = 0x00; // Reset
-    scratchpad[7] = 0x10; // 0x10
-    updateCRC(); // update scratchpad[8]
+    pad.bytes[5] = 0xFF; // 0xFF
+    pad.bytes[6] = 0x00; // Reset
+    pad.bytes[7] = 0x10; // 0x10
+    updateCRC(pad); // update pad.bytes[8]
+    scratchpad.publish();
 
-    ds18s20_mode = (ID1 == 0x10); // different tempRegister
+    memcpy(eeprom, &pad.bytes[2], sizeof(eeprom));
+
+    temperature      = 10 * 16;
+    conversion_start = 0;
+    conversion_time  = 0;
+    alarm_flag       = false;
+    parasite         = false;
 }
 
-void DS18B20::updateCRC()
+void DS18B20::updateCRC(Scratchpad &pad)
 {
-    scratchpad[8] = crc8(scratchpad, 8);
+    pad.bytes[8] = crc8(pad.bytes, 8);
 };
 
 void DS18B20::duty(OneWireHub * const hub)
@@ -27,31 +37,53 @@ void DS18B20::duty(OneWireHub * const hub)
     uint8_t cmd;
     if (hub->recv(&cmd,1)) return;
 
+    updateConversion();
+
     switch (cmd)
     {
         case 0x4E: // WRITE SCRATCHPAD
-            // write 3 byte of data to scratchpad[2:4], ds18s20 only first 2 bytes (TH, TL)
-            hub->recv(&scratchpad[2], 3); // dont return here, so crc gets updated even if write not complete
-            updateCRC();
+            {
+                // write 3 byte of data to scratchpad[2:4], ds18s20 only first 2 bytes (TH, TL)
+                Scratchpad &pad = scratchpad.get();
+                hub->recv(&pad.bytes[2], ds18s20_mode ? 2 : 3); // dont return here, so crc gets updated even if write not complete
+                if (!ds18s20_mode) pad.bytes[4] = (pad.bytes[4] & 0x60) | 0x1F; // only R1 R0 are writable
+                updateCRC(pad);
+                scratchpad.touch();
+            };
             break;
 
         case 0xBE: // READ SCRATCHPAD
-            hub->send(scratchpad, 9);
+            hub->send(scratchpad.hold().bytes, 9);
             break;
 
-        case 0x48: // COPY SCRATCHPAD to EEPROM
-            // todo: we could implement eprom here und below, copy scratchpad[2:4], ds18s20 only first 2 bytes (TH, TL)
+        case 0x48: // COPY SCRATCHPAD to EEPROM, scratchpad[2:4], ds18s20 only first 2 bytes (TH, TL)
+            memcpy(eeprom, &scratchpad.hold().bytes[2], ds18s20_mode ? 2 : 3);
             break; // send1 if parasite power is used, is passive
 
         case 0xB8: // RECALL E2 (3 byte EEPROM to Scratchpad[2:4])
+            {
+                Scratchpad &pad = scratchpad.get();
+                memcpy(&pad.bytes[2], eeprom, ds18s20_mode ? 2 : 3);
+                updateCRC(pad);
+                scratchpad.touch();
+            };
             break;// signal that OP is done, 1s is passive ...
 
         case 0xB4: // READ POWER SUPPLY
-            //hub->sendBit(0); // 1: say i am external powered, 0: uses parasite power, 1 is passive, so omit it ...
+            if (parasite) hub->sendBit(false); // 0: uses parasite power, 1: external powered is passive, so omit it ...
             break;
 
         case 0x44: // CONVERT T --> start a new measurement conversion
-            // we have 94 ... 750ms time here (9-12bit conversion)
+            startConversion();
+            if (parasite) break; // the master powers the conversion with a strong pullup, no read slots
+            while (!updateConversion()) // 0s until the conversion is done, a master that sleeps instead lets the hub go on
+            {
+                if (hub->sendBit(false))
+                {
+                    if (hub->getError() == Error::AWAIT_TIMESLOT_TIMEOUT_HIGH) hub->clearError();
+                    break;
+                };
+            };
             break; // send 1s, is passive ...
 
         default:
@@ -59,6 +91,94 @@ void DS18B20::duty(OneWireHub * const hub)
     };
 };
 
+void DS18B20::startConversion(void)
+{
+    conversion_start = millis();
+    conversion_time  = ds18s20_mode ? CONVERSION_TIME_ms : static_cast<uint16_t>(CONVERSION_TIME_ms >> (12 - getResolution())); // ds18s20 takes 750ms for 9bit
+    sample.request(*this, 0x01, conversion_time); // the value gets latched at the end, so the provider has the whole conversion-time
+};
+
+bool DS18B20::isConversionDue(void) const
+{
+    return (conversion_time != 0) && ((millis() - conversion_start) >= conversion_time);
+};
+
+bool DS18B20::updateConversion(void)
+{
+    if (conversion_time == 0)   return true;
+    if (!isConversionDue())     return false;
+
+    conversion_time = 0;
+    alarm_flag = latchConversion(scratchpad.get());
+    scratchpad.touch();
+    return true;
+};
+
+bool DS18B20::latchConversion(Scratchpad &pad)
+{
+    noInterrupts();
+    int16_t value = temperature;
+    interrupts();
+
+    // two's complement, the undefined lower bits of 9 - 11bit read as 0
+    if (ds18s20_mode)   value = static_cast<int16_t>(value >> 3); // 1/2 degC
+    else                value = static_cast<int16_t>(value & ~((int16_t(1) << (12 - getResolution(pad))) - 1));
+
+    pad.bytes[0] = static_cast<uint8_t>(value);
+    pad.bytes[1] = static_cast<uint8_t>(static_cast<uint16_t>(value) >> 8);
+    updateCRC(pad);
+
+    // TH and TL get compared with the integer part (bit 11to4) of this conversion
+    const int8_t value_degC = static_cast<int8_t>(value >> (ds18s20_mode ? 1 : 4));
+    return (value_degC >= static_cast<int8_t>(pad.bytes[2])) || (value_degC <= static_cast<int8_t>(pad.bytes[3]));
+};
+
+void DS18B20::updateAlarm(void)
+{
+    updateConversion();
+};
+
+bool DS18B20::getAlarm(void)
+{
+    while (isConversionDue()) // same as the bus, but on a shadow-copy, so a readout never sees half of it
+    {
+        const uint32_t start = conversion_start;
+        Scratchpad &pad   = scratchpad.edit();
+        const bool  value = latchConversion(pad);
+        if (!scratchpad.publish()) continue; // the bus changed the scratchpad (or finished the conversion itself), redo
+
+        noInterrupts();
+        if (conversion_start == start) // a new CONVERT T keeps running
+        {
+            conversion_time = 0;
+            alarm_flag = value;
+        };
+        interrupts();
+    };
+    return alarm_flag;
+};
+
+uint8_t DS18B20::getResolution(void) const
+{
+    return getResolution(scratchpad.get());
+};
+
+uint8_t DS18B20::getResolution(const Scratchpad &pad) const
+{
+    if (ds18s20_mode) return 9;
+    return static_cast<uint8_t>(9 + ((pad.bytes[4] >> 5) & 0x03));
+};
+
+void DS18B20::setParasitePower(const bool enable)
+{
+    parasite = enable;
+};
+
+bool DS18B20::setProvider(const SampleProvider provider, void * const context)
+{
+    return sample.setProvider(provider, context);
+};
+
 
 void DS18B20::setTemperature(const float value_degC)
 {
@@ -78,64 +198,104 @@ void DS18B20::setTemperature(const int8_t value_degC) // could be int8_t, [-55;+
 
 void DS18B20::setTemperatureRaw(const int16_t value_raw)
 {
-    int16_t value = value_raw;
+    noInterrupts(); // 16bit are no atomic write on avr
+    temperature = value_raw;
+    interrupts();
+    sample.complete(0);
+};
+
+int  DS18B20::getTemperature(void) const
+{
+    noInterrupts();
+    const int16_t value = temperature;
+    interrupts();
+    return value / 16;
+}
 
-    if (ds18s20_mode)
+#if STATE_ENABLE
+uint16_t DS18B20::getStateSize(void) const
+{
+    return sizeof(eeprom);
+};
+
+void DS18B20::readState(const uint16_t position, uint8_t destination[], const uint8_t length) const
+{
+    memcpy(destination, &eeprom[position], length);
+};
+
+void DS18B20::writeState(const uint16_t position, const uint8_t source[], const uint8_t length)
+{
+    memcpy(&eeprom[position], source, length);
+
+    do
     {
-        value /= 8; // deg*16/8 = deg*2 ...
-        if (value > 0)
-        {
-            value &= 0x00FF; // upper byte is signum (0)
-        }
-        else
-        {
-            value = -value;
-            value |= 0xFF00; // upper byte is signum (1)
-        };
+        Scratchpad &pad = scratchpad.edit(); // like the power-up of the real device: recall the eeprom
+        memcpy(&pad.bytes[2], eeprom, ds18s20_mode ? 2 : 3);
+        updateCRC(pad);
     }
-    else
-    {
-        // normal 18b20, uses always 12bit mode! also 9,10,11,12 bit possible bitPosition seems to stay the same
-        if (value > 0)
-        {
-            value &= 0x07FF; // upper 5 bits are signum
-        } else
-        {
-            value = -value;
-            value |= 0xF800;
-        };
-    };
+    while (!scratchpad.publish());
+};
+#endif
+
+#if SNAPSHOT_ENABLE
+uint16_t DS18B20::getSnapshotSize(void) const
+{
+    return SNAPSHOT_SIZE;
+};
 
-    scratchpad[0] = reinterpret_cast<uint8_t *>(&value)[0];
-    scratchpad[1] = reinterpret_cast<uint8_t *>(&value)[1];
-    // TODO: if alarms implemented - compare TH,TL with (value>>4 & 0xFF) (bit 11to4)
-    // if out of bounds >=TH, <=TL trigger flag
+void DS18B20::packSnapshot(uint8_t image[]) const
+{
+    memcpy(&image[0], eeprom, sizeof(eeprom));
+    memcpy(&image[3], scratchpad.get().bytes, 9);
 
-    updateCRC();
+    noInterrupts();
+    const int16_t  value    = temperature;
+    const uint32_t elapsed  = millis() - conversion_start;
+    const uint16_t duration = conversion_time;
+    const bool     state    = alarm_flag;
+    interrupts();
+
+    uint16_t remaining = 0; // ms, 0 if no conversion is running
+    if (duration != 0) remaining = (elapsed < duration) ? uint16_t(duration - elapsed) : uint16_t(1); // a due conversion still has to latch
+
+    image[12] = static_cast<uint8_t>(value);
+    image[13] = static_cast<uint8_t>(static_cast<uint16_t>(value) >> 8);
+    image[14] = static_cast<uint8_t>(remaining);
+    image[15] = static_cast<uint8_t>(remaining >> 8);
+    image[16] = state ? 1 : 0;
 };
 
-int  DS18B20::getTemperature(void) const
+void DS18B20::unpackSnapshot(const uint8_t image[])
 {
-    int16_t value = (scratchpad[1] << 8) | scratchpad[0];
+    memcpy(eeprom, &image[0], sizeof(eeprom));
 
-    if (ds18s20_mode)
+    do
     {
-        if (scratchpad[1] & 0xF0)
-        {
-            value &= 0x00FF;
-            value  = -value;
-        }
-        value /= 2;
+        Scratchpad &pad = scratchpad.edit(); // crc included
+        memcpy(pad.bytes, &image[3], 9);
     }
-    else
-    {
-        if (scratchpad[1] & 0xF0)
-        {
-            value &= 0x07FF;
-            value  = -value;
-        }
-        value /= 16;
-    };
+    while (!scratchpad.publish());
 
-    return value;
-}
+    noInterrupts();
+    temperature      = static_cast<int16_t>(uint16_t(image[12]) | (uint16_t(image[13]) << 8));
+    conversion_start = millis();
+    conversion_time  = uint16_t(image[14]) | (uint16_t(image[15]) << 8);
+    alarm_flag       = (image[16] != 0);
+    interrupts();
+};
+
+void DS18B20::readSnapshot(const uint16_t position, uint8_t destination[], const uint8_t length) const
+{
+    uint8_t image[SNAPSHOT_SIZE];
+    packSnapshot(image);
+    memcpy(destination, &image[position], length);
+};
+
+void DS18B20::writeSnapshot(const uint16_t position, const uint8_t source[], const uint8_t length)
+{
+    uint8_t image[SNAPSHOT_SIZE]; // the hub may write in chunks
+    packSnapshot(image);
+    memcpy(&image[position], source, length);
+    unpackSnapshot(image);
+};
+#endif
@@ -1,5 +1,6 @@
 // Digital Thermometer
-// Works, but without eeprom copy/read and alarm-setting
+// Works, with resolution, conversion-time, alarms and eeprom
+// conversions latch the value of setTemperature() and take 94 - 750ms (resolution), the master can poll the busy-state or sleep
 // DS18B20: 9-12bit, -55 - +85  degC
 // DS18S20: 9   bit, -55 - +85  degC
 // DS1822:  9-12bit, -55 - +125 degC
@@ -14,12 +15,44 @@ class DS18B20 : public OneWireItem
 {
 private:
 
-    uint8_t scratchpad[9];
+    struct Scratchpad
+    {
+        uint8_t bytes[9];
+    };
 
-    void updateCRC(void);
+    DoubleBuffer<Scratchpad> scratchpad; // setters publish a complete copy, crc included
+
+    static void updateCRC(Scratchpad &pad);
+
+    uint8_t eeprom[3]; // TH, TL and config, COPY SCRATCHPAD stores them here, RECALL E2 loads them back
+
+    static constexpr uint16_t CONVERSION_TIME_ms = 750; // 12bit, every lower bit halves it
+
+    volatile int16_t temperature;       // 1/16 degC, sensor-value for the next conversion
+    uint32_t conversion_start;          // millis()
+    uint16_t conversion_time;           // ms, 0 if no conversion is running
+    bool     parasite;
+
+    SampleRequest<> sample;             // channel 0: temperature
 
     bool ds18s20_mode;
 
+    void startConversion(void);
+    bool isConversionDue(void) const;
+    bool updateConversion(void);            // bus-side: finishes a due conversion in the published scratchpad, returns false while busy
+    bool latchConversion(Scratchpad &pad);  // writes the value of a finished conversion into pad, returns the alarm-state
+
+    uint8_t getResolution(const Scratchpad &pad) const;
+
+#if SNAPSHOT_ENABLE
+    static constexpr uint8_t SNAPSHOT_SIZE = 3 + 9 + 2 + 2 + 1; // eeprom, scratchpad, temperature, remaining conversion-time, alarm
+
+    void    packSnapshot(uint8_t image[]) const;
+    void    unpackSnapshot(const uint8_t image[]);
+#endif
+
+    void updateAlarm(void);  // poll() finishes a due conversion outside of bus-activity, so the alarm search only reads alarm_flag
+
 public:
 
     static constexpr uint8_t family_code = 0x28; // is compatible to ds1822 (0x22) and ds18S20 (0x10)
@@ -27,13 +60,30 @@ public:
     DS18B20(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
 
     void duty(OneWireHub * const hub);
+    bool getAlarm(void);  // temperature of the last conversion >= TH or <= TL, finishes a due conversion like the bus would
 
     void setTemperature(const float value_degC);  // -55 to +125 degC
     void setTemperature(const int8_t value_degC); // -55 to +125 degC
-    int  getTemperature(void) const;
+    int  getTemperature(void) const;               // sensor-value, not the last conversion
+
+    void setTemperatureRaw(const int16_t value_raw); // 1/16 degC, gets masked to the resolution by the next conversion
 
-    void setTemperatureRaw(const int16_t value_raw);
+    uint8_t getResolution(void) const;              // 9 - 12 bit, from the config-register (ds18s20: 9)
+    void    setParasitePower(const bool enable);    // READ POWER SUPPLY answers 0, conversions send no busy-slots
 
+    bool    setProvider(const SampleProvider provider, void * const context = nullptr); // only with PROVIDER_ENABLE, CONVERT T asks for channel 0, answer with setTemperature()
+
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // eeprom: TH, TL and config
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
+
+#if SNAPSHOT_ENABLE
+    uint16_t getSnapshotSize(void) const; // the eeprom, followed by scratchpad, sensor-value and a running conversion
+    void     readSnapshot(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeSnapshot(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
 };
 
 #endif
@@ -14,3 +14,20 @@ void DS2405::duty(OneWireHub * const hub)
     // TODO: when alarm search is implemented (0xEC):
     // when PIO pin is driven low this device issues an alarm, otherwise stays alarm is disabled
 };
+
+#if STATE_ENABLE
+uint16_t DS2405::getStateSize(void) const
+{
+    return 1;
+};
+
+void DS2405::readState(const uint16_t, uint8_t destination[], const uint8_t length) const
+{
+    if (length) destination[0] = pin_state;
+};
+
+void DS2405::writeState(const uint16_t, const uint8_t source[], const uint8_t length)
+{
+    if (length) pin_state = (source[0] != 0);
+};
+#endif
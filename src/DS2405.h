@@ -31,6 +31,12 @@ public:
     {
         return pin_state;
     };
+
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // the pin-state
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
 };
 
 #endif
@@ -1,34 +1,34 @@
 #include "DS2408.h"
 
+static constexpr RegisterCommand ds2408_commands[] PROGMEM =
+{
+    // cmd, address bytes, mask, first, last, crc
+    { 0xF0, 2, 0xFFFF, 0x88, 0x8F, CrcMode::END  }, // Read PIO Registers
+    { 0x5A, 0, 0x0000, 0x00, 0x00, CrcMode::NONE }, // Channel-Access Write
+    { 0xF5, 0, 0x0000, 0x00, 0x00, CrcMode::NONE }, // Channel-Access Read
+    { 0xC3, 0, 0x0000, 0x00, 0x00, CrcMode::NONE }, // reset activity latches
+    { 0xCC, 2, 0xFFFF, 0x8B, 0x8D, CrcMode::NONE }, // write conditional search register
+};
+
 DS2408::DS2408(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
 {
+    static_assert(ds2408_commands[0].first == REG_OFFSET && ds2408_commands[0].last + 1 == REG_OFFSET + MEM_SIZE, "Command-table does not match the registers");
     clearMemory();
 };
 
 void DS2408::duty(OneWireHub * const hub)
 {
     constexpr uint8_t DATA_xAA = 0xAA;
-    uint8_t cmd, reg_TA, data; // command, targetAdress and databytes
-    uint16_t crc = 0;
+    uint8_t  cmd, data; // command and databytes
+    uint16_t reg_TA, crc = 0; // targetAdress
 
-    if (hub->recv(&cmd,1,crc)) return;
+    RegisterCommand command;
+    if (hub->recvCommand(ds2408_commands, sizeof(ds2408_commands)/sizeof(RegisterCommand), command, reg_TA, crc)) return;
 
-    switch (cmd)
+    switch (command.cmd)
     {
-        case 0xF0:      // Read PIO Registers
-            if (hub->recv(&reg_TA,1,crc)) return;
-            if((reg_TA < REG_OFFSET) || (reg_TA >= REG_OFFSET + MEM_SIZE)) return;
-            if (hub->recv(&data,1,crc)) return; // seconds part of reg_TA, should be zero
-            if (data != 0) return;
-
-            {
-                const uint8_t start  = (reg_TA - REG_OFFSET);
-                const uint8_t length = MEM_SIZE - start;
-                if (hub->send(&memory[start],length,crc)) return;
-            }
-
-            crc = ~crc; // most important step, easy to miss....
-            if (hub->send(reinterpret_cast<uint8_t *>(&crc),2)) return;
+        case 0xF0:      // Read PIO Registers, second byte of reg_TA has to be zero
+            if (hub->sendRegisters(command, memory, reg_TA, crc)) return;
             break; // after memory readout this chip sends logic 1s, which is the same as staying passive
 
         case 0x5A:      // Channel-Access Write
@@ -41,6 +41,7 @@ void DS2408::duty(OneWireHub * const hub)
                 memory[REG_PIO_ACTIVITY] |= data ^ memory[REG_PIO_LOGIC];
                 memory[REG_PIO_OUTPUT]   = data;
                 memory[REG_PIO_LOGIC]    = data;
+                hub->pushEvent(*this, 0x88 + REG_PIO_OUTPUT, 1, data);
                 if (hub->send(&DATA_xAA)) return;
                 if (hub->send(memory,4)) return; // TODO: i think this is right, datasheet says: DS2408 samples the status of the PIO pins, as shown in Figure 9, and sends it to the master
             }
@@ -58,22 +59,16 @@ void DS2408::duty(OneWireHub * const hub)
         case 0xC3:      // reset activity latches
             memory[REG_PIO_ACTIVITY] = 0x00;
             while(!hub->send(&DATA_xAA));
+            return; // ends only with an error
 
         case 0xCC:      // write conditional search register
-            if (hub->recv(&reg_TA,1))                   return;
-            if(reg_TA < (REG_SEARCH_MASK + REG_OFFSET)) return;
-            if (hub->recv(&data,1))                     return; // seconds part of reg_TA, should be zero
-            if (data != 0)                              return;
-
-            while(reg_TA <= REG_CONTROL_STATUS + REG_OFFSET)
+            while(reg_TA <= command.last)
             {
                 if (hub->recv(&memory[reg_TA - REG_OFFSET],1)) return;
+                reg_TA++;
             }
             // TODO: page 18 datasheet, no alarm search yet, control-register has influence
             break;
-
-        default:
-            hub->raiseSlaveError(cmd);
     };
 };
 
@@ -126,3 +121,20 @@ uint8_t DS2408::getPinActivity(void) const
 {
     return memory[REG_PIO_ACTIVITY];
 };
+
+#if STATE_ENABLE
+uint16_t DS2408::getStateSize(void) const
+{
+    return MEM_SIZE;
+};
+
+void DS2408::readState(const uint16_t position, uint8_t destination[], const uint8_t length) const
+{
+    memcpy(destination, &memory[position], length);
+};
+
+void DS2408::writeState(const uint16_t position, const uint8_t source[], const uint8_t length)
+{
+    memcpy(&memory[position], source, length);
+};
+#endif
@@ -46,6 +46,11 @@ public:
 
     // TODO: do we need FN to set the output register?
 
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // the registers
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
 };
 
 #endif
@@ -23,6 +23,7 @@ void DS2413::duty(OneWireHub * const hub)
 
             setPinLatch(0, data & static_cast<uint8_t>(0x01));// A
             setPinLatch(1, data & static_cast<uint8_t>(0x02));// B
+            hub->pushEvent(*this, 0, 1, data & static_cast<uint8_t>(0x03)); // pio output latch
             break;
 
         case 0xF5:      // PIO ACCESS READ
@@ -41,3 +42,29 @@ void DS2413::duty(OneWireHub * const hub)
             hub->raiseSlaveError(cmd);
     };
 };
+
+#if STATE_ENABLE
+uint16_t DS2413::getStateSize(void) const
+{
+    return 4;
+};
+
+void DS2413::readState(const uint16_t position, uint8_t destination[], const uint8_t length) const
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        const uint16_t address = position + i;
+        destination[i] = (address < 2) ? pin_state[address] : pin_latch[address - 2];
+    };
+};
+
+void DS2413::writeState(const uint16_t position, const uint8_t source[], const uint8_t length)
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        const uint16_t address = position + i;
+        if (address < 2)    pin_state[address] = (source[i] != 0);
+        else                pin_latch[address - 2] = (source[i] != 0);
+    };
+};
+#endif
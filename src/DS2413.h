@@ -44,6 +44,12 @@ public:
     {
         return pin_latch[a_or_b & 1];
     };
+
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // pin-state of A and B, followed by the latches
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
 };
 
 #endif
@@ -1,82 +1,35 @@
 #include "DS2423.h"
 
-DS2423::DS2423(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
+template <bool BACKEND>
+DS2423Model<BACKEND>::DS2423Model(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
 {
-    static_assert(sizeof(memory) < 65535,  "Implementation does not cover the whole address-space");
+    static_assert(MEM_SIZE < 65535,  "Implementation does not cover the whole address-space");
 
     clearMemory();
-    clearScratchpad();
 
     for (uint8_t n = 0; n < COUNTER_COUNT; ++n) setCounter(n,0);
 };
 
-void DS2423::duty(OneWireHub * const hub)
+template <bool BACKEND>
+void DS2423Model<BACKEND>::duty(OneWireHub * const hub)
 {
-    constexpr uint32_t DUMMY_32b_ZERO   = 0x00000000;
-    constexpr uint32_t DUMMY_32b_ONES   = 0xFFFFFFFF;
-    constexpr uint8_t  ALTERNATING_10   = 0xAA;
-    static uint16_t reg_TA = 0;
-    static uint8_t  reg_ES = 0;
-    uint16_t crc = 0;  // target_address
-    uint8_t  data;
+    uint16_t reg_TA, crc = 0;  // target_address
+    uint8_t  cmd;
 
-    uint8_t cmd;
     if (hub->recv(&cmd,1,crc))  return;
 
     switch (cmd)
     {
         case 0x0F:      // Write Scratchpad
-            if (hub->recv(reinterpret_cast<uint8_t *>(&reg_TA),2,crc)) break;
-
-            reg_TA &= REG_TA_MASK; // compiler makes this to a 8bit OP, nice
-            reg_ES = uint8_t(reg_TA) & PAGE_MASK;
-
-            for (;reg_ES < PAGE_SIZE; ++reg_ES)
-            {
-                if (hub->recv(&scratchpad[reg_ES],1,crc))
-                {
-                    if (hub->getError() == Error::AWAIT_TIMESLOT_TIMEOUT_HIGH) reg_ES |= REG_ES_PF_MASK;
-                    break;
-                }
-            }
-            reg_ES--;
-            reg_ES &= PAGE_MASK;
-
-            if (hub->getError() == Error::NO_ERROR)  // try to send crc if wanted
-            {
-                crc = ~crc; // normally crc16 is sent ~inverted
-                hub->send(reinterpret_cast<uint8_t *>(&crc), 2);
-            };
+            scratchpad.write(hub, *this, crc);
             break;
 
         case 0xAA:      // read Scratchpad
-            if (hub->send(reinterpret_cast<uint8_t *>(&reg_TA),2)) break;
-            if (hub->send(&reg_ES,1)) break;
-            {
-                const uint8_t start     = uint8_t(reg_TA) & PAGE_MASK;
-                const uint8_t length    = PAGE_SIZE - start;
-                if (hub->send(&scratchpad[start],length)) return;
-            }
+            if (scratchpad.read(hub, *this, crc)) return;
             break; // send 1s, be passive ...
 
-        case 0x5A:      // copy scratchpad
-            if (hub->recv(&data,1))                              break;
-            if (data != reinterpret_cast<uint8_t *>(&reg_TA)[0]) break;
-            if (hub->recv(&data,1))                              break;
-            if (data != reinterpret_cast<uint8_t *>(&reg_TA)[1]) break;
-            if (hub->recv(&data,1))                              break;
-            if (data != reg_ES)                                  break;
-
-            if (reg_ES & REG_ES_PF_MASK)                         break; // stop if error occured earlier
-            reg_ES |= REG_ES_AA_MASK; // compare was successful
-            // we have ~30µs to write the date
-            {
-                const uint8_t start     = uint8_t(reg_TA) & PAGE_MASK;
-                const uint8_t length    = (reg_ES & PAGE_MASK) + uint8_t(1) - start;
-                writeMemory(&scratchpad[start], length, reg_TA);
-            }
-
-            while (!hub->send(&ALTERNATING_10)); // send 1s when alternating 1 & 0 after copy is complete
+        case 0x5A:      // copy scratchpad, we have ~30µs to write the date
+            scratchpad.copy(hub, *this);
             break;
 
         case 0xF0:      // READ MEMORY
@@ -89,7 +42,7 @@ void DS2423::duty(OneWireHub * const hub)
                 for (;page < PAGE_COUNT; ++page)
                 {
                     const uint8_t length = PAGE_SIZE - start;
-                    if (hub->send(&memory[(page*PAGE_SIZE) + start],length)) return;
+                    if (hub->send(&memory.getPage(page)[start],length)) return;
                     start = 0;
                 };
             };
@@ -100,53 +53,43 @@ void DS2423::duty(OneWireHub * const hub)
             reg_TA &= REG_TA_MASK; // compiler makes this to a 8bit OP, nice
 
             {
-                uint8_t page  = uint8_t(reg_TA >> 5);
-                uint8_t start = uint8_t(reg_TA) & PAGE_MASK;
-                for (;page < PAGE_COUNT; ++page)
-                {
-                    const uint8_t length = PAGE_SIZE - start;
-                    if (hub->send(&memory[(page*PAGE_SIZE) + start],length,crc)) return;
-                    start = 0;
-                    if (page >= COUNTER_PAGE_START)
-                    {
-                        if (hub->send(reinterpret_cast<uint8_t *>(&memcounter[page-COUNTER_PAGE_START]),4,crc)) return;
-                    }
-                    else
-                    {
-                        if (hub->send(reinterpret_cast<const uint8_t *>(&DUMMY_32b_ONES),4,crc)) return;
-                    };
-                    if (hub->send(reinterpret_cast<const uint8_t *>(&DUMMY_32b_ZERO),4,crc)) return;
-
-                    crc = ~crc;
-                    if (hub->send(reinterpret_cast<uint8_t *>(&crc),2)) return;
-                    crc = 0;
-                };
+                CounterPageSource source(memory, page_crc, memcounter);
+                if (hub->sendPages(source, reg_TA, MEM_SIZE, PAGE_SIZE, crc)) return;
             };
             break;
 
         default:
             hub->raiseSlaveError(cmd);
     };
-
-    if (cmd == 0x5A) clearScratchpad();
 };
 
-
-void DS2423::clearMemory(void)
+template <bool BACKEND>
+uint8_t DS2423Model<BACKEND>::CounterPageSource::getSuffix(const uint16_t page, uint8_t suffix[]) const
 {
-    memset(memory, static_cast<uint8_t>(0x00), MEM_SIZE);
+    const uint32_t value = (page >= COUNTER_PAGE_START) ? counter[page - COUNTER_PAGE_START] : 0xFFFFFFFF;
+    for (uint8_t i = 0; i < 4; ++i)
+    {
+        suffix[i]     = static_cast<uint8_t>(value >> (8*i)); // little endian
+        suffix[i + 4] = 0x00;
+    };
+    return 8;
 };
 
-void DS2423::clearScratchpad(void)
+template <bool BACKEND>
+void DS2423Model<BACKEND>::clearMemory(void)
 {
-    memset(scratchpad, static_cast<uint8_t>(0x00), PAGE_SIZE);
+    memory.fill(0x00);
+    page_crc.setDirty();
+    page_crc.update(memory);
 };
 
-bool DS2423::writeMemory(const uint8_t* const source, const uint16_t length, const uint16_t position)
+template <bool BACKEND>
+bool DS2423Model<BACKEND>::writeMemory(const uint8_t* const source, const uint16_t length, const uint16_t position)
 {
     if (position >= MEM_SIZE) return false;
     const uint16_t _length = (position + length >= MEM_SIZE) ? (MEM_SIZE - position) : length;
-    memcpy(&memory[position],source,_length);
+    memory.write(position,source,_length);
+    page_crc.setDirty(position, _length); // is also called during copy scratchpad, updateCRC() recalculates it in loop()
 
     const uint8_t page_start = uint8_t(position>>5);
     const uint8_t page_end   = uint8_t((position+length)>>5);
@@ -159,36 +102,108 @@ bool DS2423::writeMemory(const uint8_t* const source, const uint16_t length, con
     return true;
 };
 
-bool DS2423::readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position) const
+template <bool BACKEND>
+bool DS2423Model<BACKEND>::readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position) const
 {
     if (position >= MEM_SIZE) return false;
     const uint16_t _length = (position + length >= MEM_SIZE) ? (MEM_SIZE - position) : length;
-    memcpy(destination,&memory[position],_length);
+    memory.read(position,destination,_length);
     return (_length==length);
 };
 
-void     DS2423::setCounter(uint8_t counter, uint32_t value)
+template <bool BACKEND>
+bool DS2423Model<BACKEND>::setBackend(MemoryBackend &backend)
+{
+    if (!memory.setBackend(backend)) return false;
+    page_crc.setDirty();
+    page_crc.update(memory);
+    return true;
+};
+
+template <bool BACKEND>
+void DS2423Model<BACKEND>::updateCRC(void)
+{
+    page_crc.update(memory);
+};
+
+template <bool BACKEND>
+void     DS2423Model<BACKEND>::setCounter(uint8_t counter, uint32_t value)
 {
     if (counter > COUNTER_COUNT) return;
     memcounter[counter] = value;
 };
 
-uint32_t DS2423::getCounter(uint8_t counter)
+template <bool BACKEND>
+uint32_t DS2423Model<BACKEND>::getCounter(uint8_t counter)
 {
     if (counter > COUNTER_COUNT) return 0;
     return memcounter[counter];
 };
 
-void     DS2423::incrementCounter(uint8_t counter)
+template <bool BACKEND>
+void     DS2423Model<BACKEND>::incrementCounter(uint8_t counter)
 {
     if (counter > COUNTER_COUNT) return;
     if (memcounter[counter] == 0xFFFF) return;
     memcounter[counter]++;
 };
 
-void     DS2423::decrementCounter(uint8_t counter)
+template <bool BACKEND>
+void     DS2423Model<BACKEND>::decrementCounter(uint8_t counter)
 {
     if (counter > COUNTER_COUNT) return;
     if (memcounter[counter] == 0x0000) return;
     memcounter[counter]--;
 };
+
+#if STATE_ENABLE
+template <bool BACKEND>
+uint16_t DS2423Model<BACKEND>::getStateSize(void) const
+{
+    return (4 * COUNTER_COUNT) + MEM_SIZE;
+};
+
+template <bool BACKEND>
+void DS2423Model<BACKEND>::readState(const uint16_t position, uint8_t destination[], const uint8_t length) const
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        const uint16_t address = position + i;
+        if (address < (4 * COUNTER_COUNT)) destination[i] = static_cast<uint8_t>(memcounter[address >> 2] >> (8 * (address & 3)));
+        else                               destination[i] = memory.read(address - (4 * COUNTER_COUNT));
+    };
+};
+
+template <bool BACKEND>
+void DS2423Model<BACKEND>::writeState(const uint16_t position, const uint8_t source[], const uint8_t length)
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        const uint16_t address = position + i;
+        if (address < (4 * COUNTER_COUNT))
+        {
+            const uint8_t shift = 8 * (address & 3);
+            memcounter[address >> 2] = (memcounter[address >> 2] & ~(uint32_t(0xFF) << shift)) | (uint32_t(source[i]) << shift);
+        }
+        else
+        {
+            memory.write(address - (4 * COUNTER_COUNT), source[i]); // not writeMemory(), the write-counters stay untouched
+            page_crc.setDirty(address - (4 * COUNTER_COUNT), 1);
+        };
+    };
+    page_crc.update(memory);
+};
+#endif
+
+#if JOURNAL_ENABLE
+template <bool BACKEND>
+bool DS2423Model<BACKEND>::replayWrite(const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length)
+{
+    if (command != Traits::COPY_CMD) return false;
+    return writeMemory(data, length, address); // same rules as the copy of the scratchpad
+};
+#endif
+
+// both memories, RAM and MemoryBackend
+template class DS2423Model<false>; // DS2423
+template class DS2423Model<true>;  // DS2423Backed
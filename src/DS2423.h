@@ -7,7 +7,9 @@
 
 #include "OneWireItem.h"
 
-class DS2423 : public OneWireItem
+// BACKEND keeps the memory in a MemoryBackend (see setBackend()) instead of RAM, chosen per device (see the aliases below)
+template <bool BACKEND>
+class DS2423Model : public OneWireItem
 {
 private:
 
@@ -20,23 +22,44 @@ private:
     static constexpr uint8_t  COUNTER_COUNT     = 4;
     static constexpr uint8_t  COUNTER_PAGE_START= 12; // page 12&13 have write-counters, page 14&15 transmit the hw-counters
 
-    static constexpr uint8_t  REG_ES_PF_MASK    = 0b00100000; // partial byte flag
-    static constexpr uint8_t  REG_ES_ZERO_MASK  = 0b01000000; // reads always zero
-    static constexpr uint8_t  REG_ES_AA_MASK    = 0b10000000; // authorization accepted (data copied to target memory)
-
     static constexpr uint16_t REG_TA_MASK       = 0x01FF; // Adresses will be stripped of the highest 7 bytes
 
-    uint8_t     memory[MEM_SIZE]; // 4kbit max storage
-    uint8_t     scratchpad[PAGE_SIZE];
+    struct Traits : ScratchpadTraits
+    {
+        static constexpr uint8_t  SIZE          = PAGE_SIZE;
+        static constexpr uint16_t TA_MASK       = REG_TA_MASK;
+        static constexpr bool     COPY_BUSY     = false; // ram, copy is done right away
+        static constexpr bool     COPY_CLEARS   = true;
+        static constexpr uint8_t  COPY_CMD      = 0x5A;
+    };
+
+    using storage_t = MemoryStorage<MEM_SIZE, PAGE_SIZE, BACKEND>;
+    storage_t   memory; // 4kbit max storage
+    ScratchpadEngine<Traits> scratchpad;
     uint32_t    memcounter[COUNTER_COUNT];
 
-    void    clearScratchpad(void);
+    using page_crc_t = PageCRC<uint16_t, PAGE_COUNT, PAGE_SIZE>;
+    page_crc_t  page_crc; // crc of the page-data, the counter-part is still added while sending
+
+    class CounterPageSource : public StoragePageSource<storage_t, page_crc_t> // every page is followed by its counter (or ones) and 32 zero-bits
+    {
+    private:
+
+        const uint32_t * const counter;
+
+    public:
+
+        CounterPageSource(const storage_t &storage, page_crc_t &cache, const uint32_t counter_start[]) :
+                StoragePageSource<storage_t, page_crc_t>(storage, MEM_SIZE, cache), counter(counter_start) {};
+
+        uint8_t getSuffix(const uint16_t page, uint8_t suffix[]) const;
+    };
 
 public:
 
     static constexpr uint8_t family_code = 0x1D;
 
-    DS2423(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
+    DS2423Model(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
 
     void     duty(OneWireHub * const hub);
 
@@ -45,11 +68,27 @@ public:
     bool     writeMemory(const uint8_t* const source, const uint16_t length, const uint16_t position = 0);
     bool     readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position = 0) const;
 
+    bool     setBackend(MemoryBackend &backend); // only for DS2423Backed, call before attach()
+    void     updateCRC(void);                    // recalculates the page-crcs the master made dirty, call it in loop() next to poll(), so read memory + counter sends them right away
+
     void     setCounter(uint8_t counter, uint32_t value);
     uint32_t getCounter(uint8_t counter);
     void     incrementCounter(uint8_t counter);
     void     decrementCounter(uint8_t counter);
 
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // 4 counters (32bit, little endian), followed by the memory
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
+
+#if JOURNAL_ENABLE
+    bool     replayWrite(const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length); // copy scratchpad (0x5A)
+#endif
+
 };
 
+using DS2423       = DS2423Model<false>; // memory in RAM
+using DS2423Backed = DS2423Model<true>;  // memory in a MemoryBackend
+
 #endif
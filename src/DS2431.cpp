@@ -1,12 +1,11 @@
 #include "DS2431.h"
 
-DS2431::DS2431(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
+template <bool BACKEND>
+DS2431Model<BACKEND>::DS2431Model(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
 {
-    static_assert(sizeof(scratchpad) < 256, "Implementation does not cover the whole address-space");
-    static_assert(sizeof(memory) < 256,  "Implementation does not cover the whole address-space");
+    static_assert(MEM_SIZE < 256,  "Implementation does not cover the whole address-space");
 
     clearMemory();
-    clearScratchpad();
 
     page_protection = 0;
     page_eprom_mode = 0;
@@ -14,101 +13,36 @@ DS2431::DS2431(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5,
     updatePageStatus();
 };
 
-void DS2431::duty(OneWireHub * const hub)
+template <bool BACKEND>
+void DS2431Model<BACKEND>::duty(OneWireHub * const hub)
 {
-    constexpr uint8_t ALTERNATING_10 = 0xAA;
-    static uint16_t reg_TA = 0; // contains TA1, TA2
-    static uint8_t  reg_ES = 0; // E/S register
-    uint16_t crc = 0;
+    uint16_t reg_TA, crc = 0;
+    uint8_t  cmd;
 
-    uint8_t  page_offset = 0, cmd, data;
     if (hub->recv(&cmd,1,crc))  return;
 
     switch (cmd)
     {
         case 0x0F:      // WRITE SCRATCHPAD COMMAND
-            if (hub->recv(reinterpret_cast<uint8_t *>(&reg_TA),2,crc))  return;
-            reg_ES = uint8_t(reg_TA) & SCRATCHPAD_MASK;
-            page_offset = reg_ES;
-
-            // receive up to 8 bytes of data
-            for (; reg_ES < SCRATCHPAD_SIZE; ++reg_ES)
-            {
-                if (hub->recv(&scratchpad[reg_ES], 1, crc))
-                {
-                    if (hub->getError() == Error::AWAIT_TIMESLOT_TIMEOUT_HIGH) reg_ES |= REG_ES_PF_MASK;
-                    break;
-                }
-            };
-            reg_ES--;
-            reg_ES &= SCRATCHPAD_MASK;
-
-            if (hub->getError() == Error::NO_ERROR)  // try to send crc if wanted
-            {
-                crc = ~crc; // normally crc16 is sent ~inverted
-                hub->send(reinterpret_cast<uint8_t *>(&crc), 2);
-            };
-
-            if (reg_TA < (4*PAGE_SIZE)) // check if page is protected or in eprom-mode
-            {
-                const uint8_t position = uint8_t(reg_TA) & ~SCRATCHPAD_MASK;
-                if (getPageProtection(reinterpret_cast<uint8_t *>(&reg_TA)[0]))       // protected: load memory-segment to scratchpad
-                {
-                    for (uint8_t i = 0; i < SCRATCHPAD_SIZE; ++i) scratchpad[i] = memory[position + i];
-                }
-                else if (getPageEpromMode(reinterpret_cast<uint8_t *>(&reg_TA)[0]))   // eprom: logical AND of memory and data
-                {
-                    for (uint8_t i = page_offset; i <= reg_ES; ++i) scratchpad[i] &= memory[position + i];
-                };
-            };
+            if (scratchpad.write(hub, *this, crc)) return;
             break;
 
         case 0xAA:      // READ SCRATCHPAD COMMAND
-            if (hub->send(reinterpret_cast<uint8_t *>(&reg_TA),2,crc))  return;
-            if (hub->send(&reg_ES,1,crc)) return;
-
-            {   // send Scratchpad content
-                const uint8_t start  = uint8_t(reg_TA) & SCRATCHPAD_MASK;
-                const uint8_t length = (reg_ES & SCRATCHPAD_MASK)+ uint8_t(1) - start; // difference to ds2433
-                if (hub->send(&scratchpad[start],length,crc))   return;
-            }
-
-            crc = ~crc;
-            if (hub->send(reinterpret_cast<uint8_t *>(&crc),2)) return;
+            if (scratchpad.read(hub, *this, crc)) return;
             break; // send 1s when read is complete, is passive, so do nothing
 
-        case 0x55:      // COPY SCRATCHPAD COMMAND
-            if (hub->recv(&data))                                  return;
-            if (data != reinterpret_cast<uint8_t *>(&reg_TA)[0])   break;
-            if (hub->recv(&data))                                  return;
-            if (data != reinterpret_cast<uint8_t *>(&reg_TA)[1])   break;
-            if (hub->recv(&data))                                  return;
-            if (data != reg_ES)                                    return; // Auth code must match
-
-            if (getPageProtection(uint8_t(reg_TA)))                break; // stop if page is protected (WriteMemory also checks this)
-            if (reg_ES & REG_ES_PF_MASK)                           break; // stop if error occured earlier
-
-            reg_ES |= REG_ES_AA_MASK; // compare was successful
-
-            reg_TA &= ~uint16_t(SCRATCHPAD_MASK);
-
-            // Write Scratchpad to memory, writing takes about 10ms
-            writeMemory(scratchpad, SCRATCHPAD_SIZE, reinterpret_cast<uint8_t *>(&reg_TA)[0]); // checks if copy protected
-
-            do
-            {
-                hub->clearError();
-                hub->sendBit(true); // send passive 1s
-            }
-            while   (hub->getError() == Error::AWAIT_TIMESLOT_TIMEOUT_HIGH); // wait for timeslots
-
-            while (!hub->send(&ALTERNATING_10)); //  alternating 1 & 0 after copy is complete
+        case 0x55:      // COPY SCRATCHPAD COMMAND, writing takes about 10ms
+            if (scratchpad.copy(hub, *this)) return;
             break;
 
         case 0xF0:      // READ MEMORY COMMAND
             if (hub->recv(reinterpret_cast<uint8_t *>(&reg_TA),2))  return;
             if (reg_TA >= MEM_SIZE) return;
-            if (hub->send(&memory[reg_TA],MEM_SIZE - uint8_t(reg_TA),crc)) return;
+            for (uint8_t page = uint8_t(reg_TA / PAGE_SIZE), start = uint8_t(reg_TA) & PAGE_MASK; page * PAGE_SIZE < MEM_SIZE; ++page, start = 0)
+            {
+                const uint8_t end = ((MEM_SIZE - (page * PAGE_SIZE)) < PAGE_SIZE) ? uint8_t(MEM_SIZE - (page * PAGE_SIZE)) : PAGE_SIZE;
+                if (hub->send(&memory.getPage(page)[start],end - start)) return; // no crc on the wire, so none is calculated
+            };
             break; // send 1s when read is complete, is passive, so do nothing here
 
         default:
@@ -116,22 +50,36 @@ void DS2431::duty(OneWireHub * const hub)
     };
 };
 
-void DS2431::clearMemory(void)
+// protected pages load the memory-segment into the scratchpad, eprom-pages get the logical AND of memory and data
+template <bool BACKEND>
+void DS2431Model<BACKEND>::Traits::filterScratchpad(const DS2431Model &device, uint8_t scratchpad[], const uint16_t reg_TA, const uint8_t start, const uint8_t end)
 {
-    memset(memory, static_cast<uint8_t>(0x00), sizeof(memory));
+    if (reg_TA >= (4*PAGE_SIZE)) return;
+
+    const uint8_t position = uint8_t(reg_TA) & ~SCRATCHPAD_MASK;
+    if (device.getPageProtection(uint8_t(reg_TA)))
+    {
+        for (uint8_t i = 0; i < SCRATCHPAD_SIZE; ++i) scratchpad[i] = device.memory.read(position + i);
+    }
+    else if (device.getPageEpromMode(uint8_t(reg_TA)))
+    {
+        for (uint8_t i = start; i <= end; ++i) scratchpad[i] &= device.memory.read(position + i);
+    };
 };
 
-void DS2431::clearScratchpad(void)
+template <bool BACKEND>
+void DS2431Model<BACKEND>::clearMemory(void)
 {
-    memset(scratchpad, static_cast<uint8_t>(0x00), SCRATCHPAD_SIZE);
+    memory.fill((FLASH_IMAGE_ENABLE && !BACKEND) ? 0xFF : 0x00); // the overlay only drops its pages, so the image (or erased memory) shows again
 };
 
-bool DS2431::writeMemory(const uint8_t* const source, const uint8_t length, const uint8_t position)
+template <bool BACKEND>
+bool DS2431Model<BACKEND>::writeMemory(const uint8_t* const source, const uint8_t length, const uint8_t position)
 {
     for (uint8_t i = 0; i < length; ++i) {
-        if ((position + i) >= sizeof(memory)) break;
+        if ((position + i) >= MEM_SIZE) break;
         if (getPageProtection(position + i)) continue;
-        memory[position + i] = source[i];
+        memory.write(position + i, source[i]);
     };
 
     if ((position+length) > 127) updatePageStatus();
@@ -139,28 +87,47 @@ bool DS2431::writeMemory(const uint8_t* const source, const uint8_t length, cons
     return true;
 };
 
-bool DS2431::readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position) const
+template <bool BACKEND>
+bool DS2431Model<BACKEND>::readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position) const
 {
     if (position >= MEM_SIZE) return false;
     const uint16_t _length = (position + length >= MEM_SIZE) ? (MEM_SIZE - position) : length;
-    memcpy(destination,&memory[position],_length);
+    memory.read(position,destination,_length);
     return (_length==length);
 };
 
-void DS2431::setPageProtection(const uint8_t position)
+template <bool BACKEND>
+bool DS2431Model<BACKEND>::setBackend(MemoryBackend &backend)
 {
-    if      (position < 1*PAGE_SIZE)    memory[0x80] = WP_MODE;
-    else if (position < 2*PAGE_SIZE)    memory[0x81] = WP_MODE;
-    else if (position < 3*PAGE_SIZE)    memory[0x82] = WP_MODE;
-    else if (position < 4*PAGE_SIZE)    memory[0x83] = WP_MODE;
-    else if (position < 0x85)           memory[0x84] = WP_MODE;
-    else if (position == 0x85)          memory[0x85] = WP_MODE;
-    else if (position < 0x88)           memory[0x85] = EP_MODE;
+    if (!memory.setBackend(backend)) return false;
+    updatePageStatus();
+    return true;
+};
+
+template <bool BACKEND>
+bool DS2431Model<BACKEND>::setImage(const uint8_t image[])
+{
+    if (!memory.setImage(image)) return false;
+    updatePageStatus();
+    return true;
+};
+
+template <bool BACKEND>
+void DS2431Model<BACKEND>::setPageProtection(const uint8_t position)
+{
+    if      (position < 1*PAGE_SIZE)    memory.write(0x80, WP_MODE);
+    else if (position < 2*PAGE_SIZE)    memory.write(0x81, WP_MODE);
+    else if (position < 3*PAGE_SIZE)    memory.write(0x82, WP_MODE);
+    else if (position < 4*PAGE_SIZE)    memory.write(0x83, WP_MODE);
+    else if (position < 0x85)           memory.write(0x84, WP_MODE);
+    else if (position == 0x85)          memory.write(0x85, WP_MODE);
+    else if (position < 0x88)           memory.write(0x85, EP_MODE);
 
     updatePageStatus();
 };
 
-bool DS2431::getPageProtection(const uint8_t position) const
+template <bool BACKEND>
+bool DS2431Model<BACKEND>::getPageProtection(const uint8_t position) const
 {
     // should be an accurate model of the control bytes
     if      (position < 1*PAGE_SIZE)
@@ -210,16 +177,18 @@ bool DS2431::getPageProtection(const uint8_t position) const
     return false;
 };
 
-void DS2431::setPageEpromMode(const uint8_t position)
+template <bool BACKEND>
+void DS2431Model<BACKEND>::setPageEpromMode(const uint8_t position)
 {
-    if      (position < 1*PAGE_SIZE)  memory[0x80] = EP_MODE;
-    else if (position < 2*PAGE_SIZE)  memory[0x81] = EP_MODE;
-    else if (position < 3*PAGE_SIZE)  memory[0x82] = EP_MODE;
-    else if (position < 4*PAGE_SIZE)  memory[0x83] = EP_MODE;
+    if      (position < 1*PAGE_SIZE)  memory.write(0x80, EP_MODE);
+    else if (position < 2*PAGE_SIZE)  memory.write(0x81, EP_MODE);
+    else if (position < 3*PAGE_SIZE)  memory.write(0x82, EP_MODE);
+    else if (position < 4*PAGE_SIZE)  memory.write(0x83, EP_MODE);
     updatePageStatus();
 };
 
-bool DS2431::getPageEpromMode(const uint8_t position) const
+template <bool BACKEND>
+bool DS2431Model<BACKEND>::getPageEpromMode(const uint8_t position) const
 {
     if      (position < 1*PAGE_SIZE)
     {
@@ -241,25 +210,60 @@ bool DS2431::getPageEpromMode(const uint8_t position) const
 };
 
 
-bool DS2431::updatePageStatus(void)
+template <bool BACKEND>
+bool DS2431Model<BACKEND>::updatePageStatus(void)
 {
     page_eprom_mode = 0;
     page_protection = 0;
 
-    if (memory[0x80] == WP_MODE) page_protection |= 1;
-    if (memory[0x81] == WP_MODE) page_protection |= 2;
-    if (memory[0x82] == WP_MODE) page_protection |= 4;
-    if (memory[0x83] == WP_MODE) page_protection |= 8;
+    if (memory.read(0x80) == WP_MODE) page_protection |= 1;
+    if (memory.read(0x81) == WP_MODE) page_protection |= 2;
+    if (memory.read(0x82) == WP_MODE) page_protection |= 4;
+    if (memory.read(0x83) == WP_MODE) page_protection |= 8;
 
-    if (memory[0x84] == WP_MODE) page_protection |= 16;
-    if (memory[0x84] == EP_MODE) page_protection |= 16;
+    if (memory.read(0x84) == WP_MODE) page_protection |= 16;
+    if (memory.read(0x84) == EP_MODE) page_protection |= 16;
 
-    if (memory[0x85] == WP_MODE) page_protection |= 32; // only byte x85
-    if (memory[0x85] == EP_MODE) page_protection |= 64+32; // also byte x86 x87
+    if (memory.read(0x85) == WP_MODE) page_protection |= 32; // only byte x85
+    if (memory.read(0x85) == EP_MODE) page_protection |= 64+32; // also byte x86 x87
 
-    if (memory[0x80] == EP_MODE) page_eprom_mode |= 1;
-    if (memory[0x81] == EP_MODE) page_eprom_mode |= 2;
-    if (memory[0x82] == EP_MODE) page_eprom_mode |= 4;
-    if (memory[0x83] == EP_MODE) page_eprom_mode |= 8;
+    if (memory.read(0x80) == EP_MODE) page_eprom_mode |= 1;
+    if (memory.read(0x81) == EP_MODE) page_eprom_mode |= 2;
+    if (memory.read(0x82) == EP_MODE) page_eprom_mode |= 4;
+    if (memory.read(0x83) == EP_MODE) page_eprom_mode |= 8;
     return true;
 };
+
+#if STATE_ENABLE
+template <bool BACKEND>
+uint16_t DS2431Model<BACKEND>::getStateSize(void) const
+{
+    return MEM_SIZE;
+};
+
+template <bool BACKEND>
+void DS2431Model<BACKEND>::readState(const uint16_t position, uint8_t destination[], const uint8_t length) const
+{
+    memory.read(position, destination, length);
+};
+
+template <bool BACKEND>
+void DS2431Model<BACKEND>::writeState(const uint16_t position, const uint8_t source[], const uint8_t length)
+{
+    memory.write(position, source, length); // not writeMemory(), protected pages get restored too
+    updatePageStatus();
+};
+#endif
+
+#if JOURNAL_ENABLE
+template <bool BACKEND>
+bool DS2431Model<BACKEND>::replayWrite(const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length)
+{
+    if (command != Traits::COPY_CMD) return false;
+    return writeMemory(data, length, static_cast<uint8_t>(address)); // same rules as the copy of the scratchpad
+};
+#endif
+
+// both memories, RAM and MemoryBackend
+template class DS2431Model<false>; // DS2431
+template class DS2431Model<true>;  // DS2431Backed
@@ -8,7 +8,9 @@
 
 #include "OneWireItem.h"
 
-class DS2431 : public OneWireItem
+// BACKEND keeps the memory in a MemoryBackend (see setBackend()) instead of RAM, chosen per device (see the aliases below)
+template <bool BACKEND>
+class DS2431Model : public OneWireItem
 {
 private:
 
@@ -21,27 +23,44 @@ private:
     static constexpr uint8_t  SCRATCHPAD_SIZE   = 8;
     static constexpr uint8_t  SCRATCHPAD_MASK   = 0b00000111;
 
-    static constexpr uint8_t  REG_ES_PF_MASK    = 0b00100000; // partial byte flag
-    static constexpr uint8_t  REG_ES_ZERO_MASK  = 0b01011000; // reads always zero
-    static constexpr uint8_t  REG_ES_AA_MASK    = 0b10000000; // authorization accepted (data copied to target memory)
-
     static constexpr uint8_t  WP_MODE           = 0x55; // write protect mode
     static constexpr uint8_t  EP_MODE           = 0xAA; // eprom mode
 
-    uint8_t memory[MEM_SIZE];
+    struct Traits : ScratchpadTraits
+    {
+        static constexpr uint8_t  SIZE          = SCRATCHPAD_SIZE;
+        static constexpr bool     READ_CRC      = true;
+        static constexpr bool     COPY_ALIGNED  = true;
+
+        static void filterScratchpad(const DS2431Model &device, uint8_t scratchpad[], const uint16_t reg_TA, const uint8_t start, const uint8_t end);
+        static bool isCopyProtected(const DS2431Model &device, const uint16_t reg_TA) // a full overlay would drop the data, so the copy fails instead
+        {
+            return device.getPageProtection(uint8_t(reg_TA)) || ((reg_TA < MEM_SIZE) && !device.memory.isWritable(reg_TA / PAGE_SIZE));
+        };
+    };
+
+#if FLASH_IMAGE_ENABLE
+    using ram_storage_t = PagePool<MEM_SIZE, PAGE_SIZE, IMAGE_OVERLAY_SIZE>; // flash-image with a RAM-overlay of the written pages
+#else
+    using ram_storage_t = MemoryStorage<MEM_SIZE, PAGE_SIZE>;
+#endif
+    using storage_t = typename SelectType<BACKEND, MemoryStorage<MEM_SIZE, PAGE_SIZE, true>, ram_storage_t>::type;
+
+    storage_t memory;
 
-    uint8_t scratchpad[SCRATCHPAD_SIZE];
-    uint8_t page_protection;
-    uint8_t page_eprom_mode;
+    ScratchpadEngine<Traits> scratchpad;
+    uint8_t  page_protection;
+    uint8_t  page_eprom_mode;
 
-    bool    updatePageStatus(void);
-    void    clearScratchpad(void);
+    bool      updatePageStatus(void);
+
+    friend class ScratchpadCheck; // drives the engine and the traits without a pin (scratchpad_check.cpp)
 
 public:
 
     static constexpr uint8_t family_code = 0x2D;
 
-    DS2431(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
+    DS2431Model(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
 
     void    duty(OneWireHub * const hub);
 
@@ -50,11 +69,27 @@ public:
     bool    writeMemory(const uint8_t* source, const uint8_t length, const uint8_t position = 0);
     bool    readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position = 0) const;
 
+    bool    setBackend(MemoryBackend &backend); // only for DS2431Backed, call before attach(), loads the page-status
+    bool    setImage(const uint8_t image[]);    // PROGMEM-array of 144 bytes, gets copied to RAM (or the backend) without FLASH_IMAGE_ENABLE, loads the page-status
+
     void    setPageProtection(const uint8_t position);
     bool    getPageProtection(const uint8_t position) const;
 
     void    setPageEpromMode(const uint8_t position);
     bool    getPageEpromMode(const uint8_t position) const;
+
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // the memory, protection-bytes included
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
+
+#if JOURNAL_ENABLE
+    bool     replayWrite(const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length); // copy scratchpad (0x55)
+#endif
 };
 
+using DS2431       = DS2431Model<false>; // memory in RAM (or a flash-image with FLASH_IMAGE_ENABLE)
+using DS2431Backed = DS2431Model<true>;  // memory in a MemoryBackend
+
 #endif
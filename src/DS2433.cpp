@@ -1,95 +1,41 @@
 #include "DS2433.h"
 
-DS2433::DS2433(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
+template <bool BACKEND>
+DS2433Model<BACKEND>::DS2433Model(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
 {
-    static_assert(sizeof(memory) < 65535,  "Implementation does not cover the whole address-space");
+    static_assert(MEM_SIZE < 65535,  "Implementation does not cover the whole address-space");
     clearMemory();
-    clearScratchpad();
 };
 
-void DS2433::duty(OneWireHub * const hub)
+template <bool BACKEND>
+void DS2433Model<BACKEND>::duty(OneWireHub * const hub)
 {
-    constexpr uint8_t ALTERNATE_01 = 0b10101010;
-
-    static uint16_t reg_TA; // contains TA1, TA2 (Target Address)
-    static uint8_t  reg_ES = 31;  // E/S register
-
-    uint8_t  data, cmd;
-    uint16_t crc = 0;
+    uint16_t reg_TA, crc = 0; // target address
+    uint8_t  cmd;
 
     if (hub->recv(&cmd,1,crc))  return;
 
     switch (cmd)
     {
         case 0x0F:      // WRITE SCRATCHPAD COMMAND
-            if (hub->recv(reinterpret_cast<uint8_t *>(&reg_TA),2,crc)) return;
-            reg_TA &= MEM_MASK; // make sure to stay in boundary
-            reg_ES = uint8_t(reg_TA) & PAGE_MASK; // register-offset
-
-            // receive up to 8 bytes of data
-            for (; reg_ES < PAGE_SIZE; ++reg_ES)
-            {
-                if (hub->recv(&scratchpad[reg_ES], 1, crc))
-                {
-                    if (hub->getError() == Error::AWAIT_TIMESLOT_TIMEOUT_HIGH) reg_ES |= REG_ES_PF_MASK;
-                    break;
-                }
-            };
-            reg_ES--;
-            reg_ES &= PAGE_MASK;
-
-            if (hub->getError() == Error::NO_ERROR)  // try to send crc if wanted
-            {
-                crc = ~crc; // normally crc16 is sent ~inverted
-                hub->send(reinterpret_cast<uint8_t *>(&crc), 2);
-            };
+            if (scratchpad.write(hub, *this, crc)) return;
             break;
 
-        case 0x55:      // COPY SCRATCHPAD
-            if (hub->recv(&data)) return; // TA1
-            if (data != reinterpret_cast<uint8_t *>(&reg_TA)[0]) return;
-            if (hub->recv(&data)) return;  // TA2
-            if (data != reinterpret_cast<uint8_t *>(&reg_TA)[1]) return;
-            if (hub->recv(&data)) return;  // ES
-            if (data != reg_ES) return;
-
-            if (reg_ES & REG_ES_PF_MASK)                           break; // stop if error occured earlier
-
-            reg_ES |= REG_ES_AA_MASK; // compare was successful
-
-            {    // Write Scratchpad to memory, writing takes about 5ms
-                const uint8_t start  = uint8_t(reg_TA) & PAGE_MASK;
-                const uint8_t length = (reg_ES & PAGE_MASK)+ uint8_t(1) - start;
-                writeMemory(&scratchpad[start], length, reg_TA);
-            }
-
-            do
-            {
-                hub->clearError();
-                hub->sendBit(true); // send passive 1s
-            }
-            while   (hub->getError() == Error::AWAIT_TIMESLOT_TIMEOUT_HIGH); // wait for timeslots
-
-            while (!hub->send(&ALTERNATE_01)); // send alternating 1 & 0 after copy is complete
+        case 0x55:      // COPY SCRATCHPAD, writing takes about 5ms
+            if (scratchpad.copy(hub, *this)) return;
             break;
 
         case 0xAA:      // READ SCRATCHPAD COMMAND
-            if (hub->send(reinterpret_cast<uint8_t *>(&reg_TA),2))  return;
-            if (hub->send(&reg_ES,1)) return;
-
-            {   // send Scratchpad content
-                const uint8_t start  = uint8_t(reg_TA) & PAGE_MASK;
-                const uint8_t length = PAGE_SIZE - start;
-                if (hub->send(&scratchpad[start],length))   return;
-            }
+            scratchpad.read(hub, *this, crc);
             return; // datasheed says we should send all 1s, till reset (1s are passive... so nothing to do here)
 
         case 0xF0:      // READ MEMORY
             if (hub->recv(reinterpret_cast<uint8_t *>(&reg_TA),2)) return;
+            reg_TA &= MEM_MASK;
 
-            for (uint16_t i = reg_TA; i < MEM_SIZE; i+=PAGE_SIZE) // model of the 32byte scratchpad
+            for (uint8_t page = uint8_t(reg_TA / PAGE_SIZE), start = uint8_t(reg_TA) & PAGE_MASK; page < PAGE_COUNT; ++page, start = 0) // model of the 32byte scratchpad
             {
-                if (hub->send(&memory[i],PAGE_SIZE)) return;
+                if (hub->send(&memory.getPage(page)[start],PAGE_SIZE - start)) return;
             };
             return; // datasheed says we should send all 1s, till reset (1s are passive... so nothing to do here)
 
@@ -98,28 +44,59 @@ void DS2433::duty(OneWireHub * const hub)
     };
 };
 
-void DS2433::clearMemory(void)
-{
-    memset(memory, static_cast<uint8_t>(0x00), MEM_SIZE);
-};
-
-void DS2433::clearScratchpad(void)
+template <bool BACKEND>
+void DS2433Model<BACKEND>::clearMemory(void)
 {
-    memset(scratchpad, static_cast<uint8_t>(0x00), PAGE_SIZE);
+    memory.fill((FLASH_IMAGE_ENABLE && !BACKEND) ? 0xFF : 0x00); // the overlay only drops its pages, so the image (or erased memory) shows again
 };
 
-bool DS2433::writeMemory(const uint8_t* const source, const uint16_t length, const uint16_t position)
+template <bool BACKEND>
+bool DS2433Model<BACKEND>::writeMemory(const uint8_t* const source, const uint16_t length, const uint16_t position)
 {
     if (position >= MEM_SIZE) return false;
     const uint16_t _length = (position + length >= MEM_SIZE) ? (MEM_SIZE - position) : length;
-    memcpy(&memory[position],source,_length);
+    memory.write(position,source,_length);
     return true;
 };
 
-bool DS2433::readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position) const
+template <bool BACKEND>
+bool DS2433Model<BACKEND>::readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position) const
 {
     if (position >= MEM_SIZE) return false;
     const uint16_t _length = (position + length >= MEM_SIZE) ? (MEM_SIZE - position) : length;
-    memcpy(destination,&memory[position],_length);
+    memory.read(position,destination,_length);
     return (_length==length);
 };
+
+#if STATE_ENABLE
+template <bool BACKEND>
+uint16_t DS2433Model<BACKEND>::getStateSize(void) const
+{
+    return MEM_SIZE;
+};
+
+template <bool BACKEND>
+void DS2433Model<BACKEND>::readState(const uint16_t position, uint8_t destination[], const uint8_t length) const
+{
+    memory.read(position, destination, length);
+};
+
+template <bool BACKEND>
+void DS2433Model<BACKEND>::writeState(const uint16_t position, const uint8_t source[], const uint8_t length)
+{
+    memory.write(position, source, length);
+};
+#endif
+
+#if JOURNAL_ENABLE
+template <bool BACKEND>
+bool DS2433Model<BACKEND>::replayWrite(const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length)
+{
+    if (command != Traits::COPY_CMD) return false;
+    return writeMemory(data, length, address); // same rules as the copy of the scratchpad
+};
+#endif
+
+// both memories, RAM and MemoryBackend
+template class DS2433Model<false>; // DS2433
+template class DS2433Model<true>;  // DS2433Backed
@@ -7,7 +7,9 @@
 
 #include "OneWireItem.h"
 
-class DS2433 : public OneWireItem
+// BACKEND keeps the memory in a MemoryBackend (see setBackend()) instead of RAM, chosen per device (see the aliases below)
+template <bool BACKEND>
+class DS2433Model : public OneWireItem
 {
 private:
 
@@ -18,20 +20,29 @@ private:
     static constexpr uint16_t PAGE_COUNT        = MEM_SIZE / PAGE_SIZE;
     static constexpr uint8_t  PAGE_MASK         = 0b00011111;
 
-    static constexpr uint8_t  REG_ES_PF_MASK    = 0b00100000; // partial byte flag
-    static constexpr uint8_t  REG_ES_ZERO_MASK  = 0b01000000; // reads always zero
-    static constexpr uint8_t  REG_ES_AA_MASK    = 0b10000000; // authorization accepted (data copied to target memory)
+    struct Traits : ScratchpadTraits
+    {
+        static constexpr uint8_t  SIZE      = PAGE_SIZE;
+        static constexpr uint16_t TA_MASK   = MEM_MASK;
 
-    uint8_t memory[MEM_SIZE]; // 4kbit max storage
-    uint8_t scratchpad[PAGE_SIZE];
+        static bool isCopyProtected(const DS2433Model &device, const uint16_t reg_TA) { return !device.memory.isWritable(reg_TA / PAGE_SIZE); }; // a full overlay would drop the data, so the copy fails instead
+    };
 
-    void    clearScratchpad(void);
+#if FLASH_IMAGE_ENABLE
+    using ram_storage_t = PagePool<MEM_SIZE, PAGE_SIZE, IMAGE_OVERLAY_SIZE>; // flash-image with a RAM-overlay of the written pages
+#else
+    using ram_storage_t = MemoryStorage<MEM_SIZE, PAGE_SIZE>;
+#endif
+    using storage_t = typename SelectType<BACKEND, MemoryStorage<MEM_SIZE, PAGE_SIZE, true>, ram_storage_t>::type;
+
+    storage_t memory; // 4kbit max storage
+    ScratchpadEngine<Traits> scratchpad;
 
 public:
 
     static constexpr uint8_t family_code = 0x23;
 
-    DS2433(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
+    DS2433Model(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
 
     void    duty(OneWireHub * const hub);
 
@@ -39,6 +50,22 @@ public:
 
     bool    writeMemory(const uint8_t* const source, const uint16_t length, const uint16_t position = 0);
     bool    readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position = 0) const;
+
+    bool    setBackend(MemoryBackend &backend) { return memory.setBackend(backend); }; // only for DS2433Backed, call before attach()
+    bool    setImage(const uint8_t image[]) { return memory.setImage(image); };          // PROGMEM-array of 512 bytes, gets copied to RAM (or the backend) without FLASH_IMAGE_ENABLE
+
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // the memory
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
+
+#if JOURNAL_ENABLE
+    bool     replayWrite(const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length); // copy scratchpad (0x55)
+#endif
 };
 
+using DS2433       = DS2433Model<false>; // memory in RAM (or a flash-image with FLASH_IMAGE_ENABLE)
+using DS2433Backed = DS2433Model<true>;  // memory in a MemoryBackend
+
 #endif
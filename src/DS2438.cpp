@@ -1,38 +1,50 @@
 #include "DS2438.h"
 
-DS2438::DS2438(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
+template <uint8_t PAGES>
+DS2438Model<PAGES>::DS2438Model(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
 {
-    static_assert(sizeof(memory) < 256,  "Implementation does not cover the whole address-space");
+    static_assert(MEM_SIZE < 256,  "Implementation does not cover the whole address-space");
+    static_assert((PAGE_COUNT >= 1) && (PAGE_COUNT <= 8), "The device has 1 to 8 pages");
 
     clearMemory();
 };
 
-void DS2438::duty(OneWireHub * const hub)
+template <uint8_t PAGES>
+void DS2438Model<PAGES>::duty(OneWireHub * const hub)
 {
     uint8_t page, cmd;
     if (hub->recv(&cmd))  return;
 
+    updateBusy();
+
     switch (cmd)
     {
         // reordered for better timing
         case 0xBE:      // Read Scratchpad
             if (hub->recv(&page))  return;
             if (page >= PAGE_COUNT) return;
-            if (hub->send(&memory[page * 8], 8)) return;
-            if (hub->send(crc[page])) return;
+            {
+                const Memory &mem = memory.hold(); // one snapshot for data and crc
+                if (hub->send(&mem.bytes[page * 8], 8)) return;
+                if (hub->send(mem.crc[page])) return;
+            };
             break;
 
         case 0x4E:      // Write Scratchpad
             if (hub->recv(&page))  return;
             if (page >= PAGE_COUNT) return; // when page out of limits
-            for (uint8_t nByte = page<<3; nByte < (page+1)<<3; ++nByte)
             {
-                uint8_t data;
-                if (hub->recv(&data, 1)) return;
-                if ((nByte < 7) && (nByte > 0)) continue; // byte 1-6 are read only
-                memory[nByte] = data;
+                Memory &mem = memory.get();
+                for (uint8_t nByte = page<<3; nByte < (page+1)<<3; ++nByte)
+                {
+                    uint8_t data;
+                    if (hub->recv(&data, 1)) return;
+                    if ((nByte < 7) && (nByte > 0)) continue; // byte 1-6 are read only
+                    mem.bytes[nByte] = data;
+                    memory.touch();
+                };
+                calcCRC(mem, page);
             };
-            calcCRC(page);
             break;
 
         case 0x48:      // copy scratchpad
@@ -44,9 +56,11 @@ void DS2438::duty(OneWireHub * const hub)
             break;
 
         case 0x44:      // Convert T
+            if (sample.request(*this, uint8_t(1) << CHANNEL_TEMPERATURE, CONVERSION_TIME_ms)) updateBusy();
             break; //hub->sendBit(1); // 1 is passive, so ommit it ...
 
         case 0xB4:      // Convert V
+            if (sample.request(*this, uint8_t(1) << CHANNEL_VOLTAGE, CONVERSION_TIME_ms)) updateBusy();
             break; //hub->sendBit(1); // 1 is passive, so ommit it ...
 
         default:
@@ -54,106 +68,210 @@ void DS2438::duty(OneWireHub * const hub)
     };
 };
 
-void DS2438::calcCRC(const uint8_t page)
+template <uint8_t PAGES>
+void DS2438Model<PAGES>::calcCRC(Memory &mem, const uint8_t page)
 {
-    if (page  < PAGE_COUNT)  crc[page] = crc8(&memory[page * 8], 8);
+    if (page  < PAGE_COUNT)  mem.crc[page] = crc8(&mem.bytes[page * 8], 8);
 };
 
-void DS2438::clearMemory(void)
+template <uint8_t PAGES>
+void DS2438Model<PAGES>::updateBusy(void)
 {
-    memcpy(memory,MemDS2438,(PAGE_COUNT*PAGE_SIZE));
+    const uint8_t pending = sample.getPending();
+    uint8_t flags = 0;
+    if (pending & (uint8_t(1) << CHANNEL_TEMPERATURE))  flags |= REG0_MASK_TB;
+    if (pending & (uint8_t(1) << CHANNEL_VOLTAGE))      flags |= REG0_MASK_ADB;
+
+    Memory &mem = memory.get();
+    if ((mem.bytes[0] & (REG0_MASK_TB | REG0_MASK_ADB)) == flags) return;
+    mem.bytes[0] = static_cast<uint8_t>((mem.bytes[0] & ~(REG0_MASK_TB | REG0_MASK_ADB)) | flags);
+    calcCRC(mem, 0);
+    memory.touch();
+};
 
-    memory[0] |= REG0_MASK_IAD;  // enable automatic current measurements
-    memory[0] |= REG0_MASK_CA;   // enable current accumulator (page7, byte 4-7)
-    memory[0] &= ~REG0_MASK_AD;  // 1: battery voltage, 0: ADC-GPIO
-    memory[0] &= ~REG0_MASK_TB;  // temperature busy flag
-    memory[0] &= ~REG0_MASK_NVB; // eeprom busy flag
-    memory[0] &= ~REG0_MASK_ADB; // adc busy flag
+template <uint8_t PAGES>
+bool DS2438Model<PAGES>::setProvider(const SampleProvider provider, void * const context)
+{
+    return sample.setProvider(provider, context);
+};
 
-    for (uint8_t page = 0; page < PAGE_COUNT; ++page)
+template <uint8_t PAGES>
+void DS2438Model<PAGES>::clearMemory(void)
+{
+    do
     {
-        calcCRC(page);
-    };
+        Memory &mem = memory.edit();
+        memcpy(mem.bytes,MemDS2438,(PAGE_COUNT*PAGE_SIZE));
+
+        mem.bytes[0] |= REG0_MASK_IAD;  // enable automatic current measurements
+        mem.bytes[0] |= REG0_MASK_CA;   // enable current accumulator (page7, byte 4-7)
+        mem.bytes[0] &= ~REG0_MASK_AD;  // 1: battery voltage, 0: ADC-GPIO
+        mem.bytes[0] &= ~REG0_MASK_TB;  // temperature busy flag
+        mem.bytes[0] &= ~REG0_MASK_NVB; // eeprom busy flag
+        mem.bytes[0] &= ~REG0_MASK_ADB; // adc busy flag
+
+        for (uint8_t page = 0; page < PAGE_COUNT; ++page)
+        {
+            calcCRC(mem, page);
+        };
+    }
+    while (!memory.publish());
 };
 
-bool DS2438::writeMemory(const uint8_t* const source, const uint8_t length, const uint8_t position)
+template <uint8_t PAGES>
+bool DS2438Model<PAGES>::writeMemory(const uint8_t* const source, const uint8_t length, const uint8_t position)
 {
     if (position >= MEM_SIZE) return false;
     const uint16_t _length = (position + length >= MEM_SIZE) ? (MEM_SIZE - position) : length;
-    memcpy(&memory[position],source,_length);
 
     const uint8_t page_start = uint8_t(position>>3);
     const uint8_t page_end   = uint8_t((position+length)>>3);
 
-    for (uint8_t page = page_start; page <= page_end; ++page)// page 12 & 13 have write-counters, page 14&15 have hw-counters
+    do
     {
-        calcCRC(page);
-    };
+        Memory &mem = memory.edit();
+        memcpy(&mem.bytes[position],source,_length);
+
+        for (uint8_t page = page_start; page <= page_end; ++page)// page 12 & 13 have write-counters, page 14&15 have hw-counters
+        {
+            calcCRC(mem, page);
+        };
+    }
+    while (!memory.publish());
 
     return true;
 };
 
-bool DS2438::readMemory(uint8_t* const destination, const uint8_t length, const uint8_t position) const
+template <uint8_t PAGES>
+bool DS2438Model<PAGES>::readMemory(uint8_t* const destination, const uint8_t length, const uint8_t position) const
 {
     if (position >= MEM_SIZE) return false;
     const uint16_t _length = (position + length >= MEM_SIZE) ? (MEM_SIZE - position) : length;
-    memcpy(destination,&memory[position],_length);
+    memcpy(destination,&memory.get().bytes[position],_length);
     return (_length==length);
 };
 
-void DS2438::setTemperature(const float temp_degC)
+template <uint8_t PAGES>
+void DS2438Model<PAGES>::setTemperature(const float temp_degC)
 {
     int16_t value = static_cast<int16_t>(temp_degC * 256.0);
 
     if (value > 125*256) value = 125*256;
     if (value < -55*256) value = -55*256;
 
-    memory[1] = static_cast<uint8_t>(value&0xF8);
-    memory[2] = uint8_t(value >> 8);
-
-    calcCRC(0);
+    do
+    {
+        Memory &mem = memory.edit();
+        mem.bytes[0] &= ~REG0_MASK_TB;
+        mem.bytes[1] = static_cast<uint8_t>(value&0xF8);
+        mem.bytes[2] = uint8_t(value >> 8);
+        calcCRC(mem, 0);
+    }
+    while (!memory.publish());
+    sample.complete(CHANNEL_TEMPERATURE);
 };
 
-void DS2438::setTemperature(const int8_t temp_degC) // can vary from -55 to 125deg
+template <uint8_t PAGES>
+void DS2438Model<PAGES>::setTemperature(const int8_t temp_degC) // can vary from -55 to 125deg
 {
     int8_t value = temp_degC;
 
     if (value > 125) value = 125;
     if (value < -55) value = -55;
 
-    memory[1] = 0;
-    memory[2] = static_cast<uint8_t>(value);
+    do
+    {
+        Memory &mem = memory.edit();
+        mem.bytes[0] &= ~REG0_MASK_TB;
+        mem.bytes[1] = 0;
+        mem.bytes[2] = static_cast<uint8_t>(value);
+        calcCRC(mem, 0);
+    }
+    while (!memory.publish());
+    sample.complete(CHANNEL_TEMPERATURE);
+};
+
+template <uint8_t PAGES>
+int8_t DS2438Model<PAGES>::getTemperature() const
+{
+    return memory.get().bytes[2];
+};
+
 
-    calcCRC(0);
+template <uint8_t PAGES>
+void DS2438Model<PAGES>::setVoltage(const uint16_t voltage_10mV) // 10 bit
+{
+    do
+    {
+        Memory &mem = memory.edit();
+        mem.bytes[0] &= ~REG0_MASK_ADB;
+        mem.bytes[3] = uint8_t(voltage_10mV & 0xFF);
+        mem.bytes[4] = uint8_t((voltage_10mV >> 8) & static_cast<uint8_t>(0x03));
+        calcCRC(mem, 0);
+    }
+    while (!memory.publish());
+    sample.complete(CHANNEL_VOLTAGE);
 };
 
-int8_t DS2438::getTemperature() const
+template <uint8_t PAGES>
+uint16_t DS2438Model<PAGES>::getVoltage(void) const
 {
-    return memory[2];
+    const Memory &mem = memory.get();
+    return ((mem.bytes[4]<<8) | mem.bytes[3]);
 };
 
+template <uint8_t PAGES>
+void DS2438Model<PAGES>::setCurrent(const int16_t value) // signed 11 bit
+{
+    do
+    {
+        Memory &mem = memory.edit();
+        mem.bytes[5] = uint8_t(value & 0xFF);
+        mem.bytes[6] = uint8_t((value >> 8) & static_cast<uint8_t>(0x03));
+        if (value<0) mem.bytes[6] |= 0xFC; // all upper bits (7:2) are the signum
+        calcCRC(mem, 0);
+    }
+    while (!memory.publish());
+};
 
-void DS2438::setVoltage(const uint16_t voltage_10mV) // 10 bit
+template <uint8_t PAGES>
+int16_t DS2438Model<PAGES>::getCurrent(void) const
 {
-    memory[3] = uint8_t(voltage_10mV & 0xFF);
-    memory[4] = uint8_t((voltage_10mV >> 8) & static_cast<uint8_t>(0x03));
-    calcCRC(0);
+    const Memory &mem = memory.get();
+    return ((mem.bytes[6]<<8) | mem.bytes[5]);
 };
 
-uint16_t DS2438::getVoltage(void) const
+#if STATE_ENABLE
+template <uint8_t PAGES>
+uint16_t DS2438Model<PAGES>::getStateSize(void) const
 {
-    return ((memory[4]<<8) | memory[3]);
+    return sizeof(Memory);
 };
 
-void DS2438::setCurrent(const int16_t value) // signed 11 bit
+template <uint8_t PAGES>
+void DS2438Model<PAGES>::readState(const uint16_t position, uint8_t destination[], const uint8_t length) const
 {
-    memory[5] = uint8_t(value & 0xFF);
-    memory[6] = uint8_t((value >> 8) & static_cast<uint8_t>(0x03));
-    if (value<0) memory[6] |= 0xFC; // all upper bits (7:2) are the signum
-    calcCRC(0);
+    memcpy(destination, reinterpret_cast<const uint8_t *>(&memory.get()) + position, length);
 };
 
-int16_t DS2438::getCurrent(void) const
+template <uint8_t PAGES>
+void DS2438Model<PAGES>::writeState(const uint16_t position, const uint8_t source[], const uint8_t length)
 {
-    return ((memory[6]<<8) | memory[5]);
+    do
+    {
+        Memory &mem = memory.edit();
+        memcpy(reinterpret_cast<uint8_t *>(&mem) + position, source, length);
+    }
+    while (!memory.publish());
 };
+#endif
+
+// every valid size, unused ones get dropped by the linker (gc-sections)
+template class DS2438Model<1>;
+template class DS2438Model<2>;
+template class DS2438Model<3>;
+template class DS2438Model<4>;
+template class DS2438Model<5>;
+template class DS2438Model<6>;
+template class DS2438Model<7>;
+template class DS2438Model<8>;
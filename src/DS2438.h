@@ -46,11 +46,13 @@ struct DS2438_page0 // overlay with memory if needed (like done in ds2408)
 };
 
 
-class DS2438 : public OneWireItem
+// PAGES: how much of the real 8 pages should be emulated, use at least 1, max 8 - smaller models save ram
+template <uint8_t PAGES>
+class DS2438Model : public OneWireItem
 {
 private:
 
-    static constexpr uint8_t PAGE_COUNT     = 8; // how much of the real 8 pages should be emulated, use at least 1, max 8
+    static constexpr uint8_t PAGE_COUNT     = PAGES;
     static constexpr uint8_t PAGE_SIZE      = 8; //
 
     static constexpr uint8_t MEM_SIZE          = PAGE_COUNT * PAGE_SIZE;
@@ -64,16 +66,30 @@ private:
     static constexpr uint8_t REG0_MASK_NVB  = 0x20; // eeprom busy flag
     static constexpr uint8_t REG0_MASK_ADB  = 0x40; // adc busy flag
 
-    uint8_t memory[MEM_SIZE];  // this mem is the "scratchpad" in the datasheet., no EEPROM implemented
-    uint8_t crc[PAGE_COUNT+1]; // keep the matching crc for each memory-page, reading can be very timesensitive
+    static constexpr uint16_t CONVERSION_TIME_ms = 10; // temperature and voltage
 
-    void calcCRC(const uint8_t page);
+    struct Memory
+    {
+        uint8_t bytes[MEM_SIZE];  // this mem is the "scratchpad" in the datasheet., no EEPROM implemented
+        uint8_t crc[PAGE_COUNT+1]; // keep the matching crc for each memory-page, reading can be very timesensitive
+    };
+
+    DoubleBuffer<Memory> memory; // setters publish a complete copy, crc included
+
+    static void calcCRC(Memory &mem, const uint8_t page);
+
+    SampleRequest<> sample;
+
+    void updateBusy(void); // TB and ADB show the requested samples
 
 public:
 
     static constexpr uint8_t family_code = 0x26;
 
-    DS2438(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
+    static constexpr uint8_t CHANNEL_TEMPERATURE = 0; // of the SampleProvider
+    static constexpr uint8_t CHANNEL_VOLTAGE     = 1;
+
+    DS2438Model(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
 
     void     duty(OneWireHub * const hub);
 
@@ -91,6 +107,16 @@ public:
 
     void     setCurrent(const int16_t value);  // signed 11 bit
     int16_t  getCurrent(void) const;
+
+    bool     setProvider(const SampleProvider provider, void * const context = nullptr); // only with PROVIDER_ENABLE, convert T / V ask for a channel, answer with setTemperature() / setVoltage()
+
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // the published memory with its crcs, a restore needs no recalculation
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
 };
 
+using DS2438 = DS2438Model<8>;
+
 #endif
@@ -1,52 +1,61 @@
 #include "DS2450.h"
 
+static constexpr RegisterCommand ds2450_commands[] PROGMEM =
+{
+    // cmd, address bytes, mask, first, last, crc
+    { 0xAA, 2, 0xFFFF, 0x00, 0x1F,   CrcMode::NONE }, // READ MEMORY, the pages stream with their own crc16 (sendPages())
+    { 0x55, 2, 0xFFFF, 0x00, 0x1F,   CrcMode::NONE }, // write memory, crc16 after every byte
+    { 0x3C, 2, 0xFFFF, 0x00, 0xFFFF, CrcMode::END  }, // convert, "address" is input select mask and read out control
+};
+
 DS2450::DS2450(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) :
         OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
 {
-    static_assert(sizeof(memory) < 256,  "Implementation does not cover the whole address-space");
+    static_assert(MEM_SIZE < 256,  "Implementation does not cover the whole address-space");
+    static_assert(ds2450_commands[0].last + 1 == MEM_SIZE, "Command-table does not match the memory");
     clearMemory();
 };
 
 void DS2450::duty(OneWireHub * const hub)
 {
     uint16_t reg_TA, crc = 0; // target address
-    uint8_t  cmd;
 
-    if (hub->recv(&cmd,1,crc))  return;
-    if (hub->recv(reinterpret_cast<uint8_t *>(&reg_TA),2,crc)) return;
+    RegisterCommand command;
+    if (hub->recvCommand(ds2450_commands, sizeof(ds2450_commands)/sizeof(RegisterCommand), command, reg_TA, crc)) return;
 
-    switch (cmd)
+    switch (command.cmd)
     {
         case 0xAA: // READ MEMORY
-            while(reg_TA < MEM_SIZE)
             {
-                const uint8_t length = PAGE_SIZE - (uint8_t(reg_TA) & PAGE_MASK);
-                if (hub->send(&memory[reg_TA], length, crc)) return;
-
-                crc = ~crc; // normally crc16 is sent ~inverted
-                if (hub->send(reinterpret_cast<uint8_t *>(&crc), 2)) return;
-
-                // prepare next page-readout
-                reg_TA += length;
-                crc = 0;
+                Memory &mem = memory.hold(); // stays the same snapshot for the whole readout
+                CachedPageSource<page_crc_t> source(mem.bytes, MEM_SIZE, mem.page_crc);
+                if (hub->sendPages(source, reg_TA, MEM_SIZE, PAGE_SIZE, crc)) return;
             };
             break;
 
         case 0x55: // write memory (only page 1&2 allowed)
-            while(reg_TA < MEM_SIZE)
             {
-                uint8_t data;
-                if (hub->recv(&data, 1, crc))   break;
-
-                crc = ~crc; // normally crc16 is sent ~inverted
-                if (hub->send(reinterpret_cast<uint8_t *>(&crc), 2)) break;
-
-                if (hub->send(&data, 1))        break;
-                if (reg_TA >= PAGE_SIZE)        memory[reg_TA] = data; // write data, page 0 is off limits
-
-                crc = ++reg_TA; // prepare next address-readout: load new TA into crc
+                Memory &mem = memory.get();
+                while(reg_TA < MEM_SIZE)
+                {
+                    uint8_t data;
+                    if (hub->recv(&data, 1, crc))   break;
+
+                    crc = ~crc; // normally crc16 is sent ~inverted
+                    if (hub->send(reinterpret_cast<uint8_t *>(&crc), 2)) break;
+
+                    if (hub->send(&data, 1))        break;
+                    if (reg_TA >= PAGE_SIZE)        // write data, page 0 is off limits
+                    {
+                        mem.bytes[reg_TA] = data;
+                        mem.page_crc.setDirty(reg_TA, 1);
+                    };
+
+                    crc = ++reg_TA; // prepare next address-readout: load new TA into crc
+                };
+                correctMemory(mem);
+                memory.touch();
             };
-            correctMemory();
             break;
 
         case 0x3C: // convert, starts adc
@@ -55,46 +64,64 @@ void DS2450::duty(OneWireHub * const hub)
             crc = ~crc; // normally crc16 is sent ~inverted
             if (hub->send(reinterpret_cast<uint8_t *>(&crc),2)) return;
             // takes max 5.3 ms for 16 bit ( 4 CH * 16 bit * 80 us + 160 us per request = 5.3 ms )
+            if (sample.request(*this, uint8_t(reg_TA) & 0x0F, CONVERSION_TIME_ms)) // input select mask
+            {
+                while (sample.getPending() != 0) // 0s until the provider delivered every channel or the window is over
+                {
+                    if (hub->sendBit(false))
+                    {
+                        if (hub->getError() == Error::AWAIT_TIMESLOT_TIMEOUT_HIGH) hub->clearError();
+                        break;
+                    };
+                };
+                break;
+            };
             if (hub->sendBit(false)) return; // still converting....
             break; // finished conversion: send 1, is passive ...
-
-        default:
-            hub->raiseSlaveError(cmd);
     };
 };
 
 void DS2450::clearMemory(void)
 {
-    memset(memory, static_cast<uint8_t>(0), MEM_SIZE);
-
-    // set power on defaults
-    for (uint8_t adc = 0; adc < POTI_COUNT; ++adc)
+    do
     {
-        // CONTROL/STATUS DATA
-        memory[(1*PAGE_SIZE) + (adc*2) + 0] = 0x00; // 16bit
-        memory[(1*PAGE_SIZE) + (adc*2) + 1] = 0x8C; // enable POR, Alarm enable high / low
-        // alarm settings
-        memory[(2*PAGE_SIZE) + (adc*2) + 1] = 0xFF; // high threshold max
-    };
+        Memory &mem = memory.edit();
+        memset(mem.bytes, static_cast<uint8_t>(0), MEM_SIZE);
+
+        // set power on defaults
+        for (uint8_t adc = 0; adc < POTI_COUNT; ++adc)
+        {
+            // CONTROL/STATUS DATA
+            mem.bytes[(1*PAGE_SIZE) + (adc*2) + 0] = 0x00; // 16bit
+            mem.bytes[(1*PAGE_SIZE) + (adc*2) + 1] = 0x8C; // enable POR, Alarm enable high / low
+            // alarm settings
+            mem.bytes[(2*PAGE_SIZE) + (adc*2) + 1] = 0xFF; // high threshold max
+        };
+
+        mem.page_crc.setDirty();
+        mem.page_crc.update(mem.bytes);
+    }
+    while (!memory.publish());
 };
 
-void DS2450::correctMemory(void)
+void DS2450::correctMemory(Memory &mem)
 {
     for (uint8_t adc = 0; adc < POTI_COUNT; ++adc)
     {
         //// control / status data
         /// byte 0,2,4,6
         // bit 0:3 -> RC3 sets resolution of the ADCs. 1to15bits and 0 for 16 bits. MSB aligned
-        memory[(1*PAGE_SIZE) + (adc*2)] &= 0b11001111; // bit 4:5 must be always zero
+        mem.bytes[(1*PAGE_SIZE) + (adc*2)] &= 0b11001111; // bit 4:5 must be always zero
         // bit 6 -> output control: set 0 for enablesd transistors
         // bit 7 -> output enable: set 0 for ADC,
         /// byte 1,3,5,7
         // bit 0 -> IR sets input voltage: 0 for 2.55 V, 1 for 5.1 V
-        memory[(1*PAGE_SIZE) + (adc*2) + 1] &= 0b10111101; // bit 1&6 -> always zero
+        mem.bytes[(1*PAGE_SIZE) + (adc*2) + 1] &= 0b10111101; // bit 1&6 -> always zero
         // bit 2:3 -> enable alarm search low, high
         // bit 4:5 -> alarm flag for low, high
         // bit 7 -> power on reset, must be written 0 by master
     };
+    mem.page_crc.setDirty(1);
 };
 
 bool DS2450::setPotentiometer(const uint16_t p1, const uint16_t p2, const uint16_t p3, const uint16_t p4)
@@ -111,19 +138,64 @@ bool DS2450::setPotentiometer(const uint8_t channel, const uint16_t value)
     if (channel >= POTI_COUNT) return false;
     uint8_t LByte = static_cast<uint8_t>(value>>0) & static_cast<uint8_t>(0xFF);
     uint8_t HByte = static_cast<uint8_t>(value>>8) & static_cast<uint8_t>(0xFF);
-    memory[(2*channel)  ] = LByte;
-    memory[(2*channel)+1] = HByte;
-    correctMemory();
+    do
+    {
+        Memory &mem = memory.edit();
+        mem.bytes[(2*channel)  ] = LByte;
+        mem.bytes[(2*channel)+1] = HByte;
+        mem.page_crc.setDirty(0);
+        correctMemory(mem);
+        mem.page_crc.update(mem.bytes);
+    }
+    while (!memory.publish());
+    sample.complete(channel);
     return true; // TODO: check with alarm settings p2, and raise alarm, also check when data is written
 };
 
+void DS2450::updateCRC(void)
+{
+    if (!memory.get().page_crc.isDirty()) return; // saves the copy
+    do
+    {
+        Memory &mem = memory.edit();
+        mem.page_crc.update(mem.bytes);
+    }
+    while (!memory.publish());
+};
+
+bool DS2450::setProvider(const SampleProvider provider, void * const context)
+{
+    return sample.setProvider(provider, context);
+};
+
 uint16_t DS2450::getPotentiometer(const uint8_t channel) const
 {
     if (channel >= POTI_COUNT) return 0;
+    const Memory &mem = memory.get();
     uint16_t value;
-    value  = memory[(2*channel)+1]<<8;
-    value |= memory[(2*channel)  ];
+    value  = mem.bytes[(2*channel)+1]<<8;
+    value |= mem.bytes[(2*channel)  ];
     return value;
 }
 
+#if STATE_ENABLE
+uint16_t DS2450::getStateSize(void) const
+{
+    return sizeof(Memory);
+};
+
+void DS2450::readState(const uint16_t position, uint8_t destination[], const uint8_t length) const
+{
+    memcpy(destination, reinterpret_cast<const uint8_t *>(&memory.get()) + position, length);
+};
 
+void DS2450::writeState(const uint16_t position, const uint8_t source[], const uint8_t length)
+{
+    do
+    {
+        Memory &mem = memory.edit();
+        memcpy(reinterpret_cast<uint8_t *>(&mem) + position, source, length);
+    }
+    while (!memory.publish());
+};
+#endif
@@ -18,13 +18,26 @@ private:
 
     static constexpr uint8_t MEM_SIZE    = PAGE_COUNT*PAGE_SIZE;
 
-    uint8_t memory[MEM_SIZE];
-    // Page1 : conversion results:  16 bit for Channel A, B, C & D, power on default: 0x00
-    // Page2 : control / status:    16 bit per channel
-    // Page3 : alarm settings:      16 bit per channel
-    // Page3 : factory calibration
+    static constexpr uint16_t CONVERSION_TIME_ms = 6; // max 5.3ms for 4 channels with 16 bit
 
-    void correctMemory(void);
+    using page_crc_t = PageCRC<uint16_t, PAGE_COUNT, PAGE_SIZE>;
+
+    struct Memory
+    {
+        uint8_t    bytes[MEM_SIZE];
+        // Page1 : conversion results:  16 bit for Channel A, B, C & D, power on default: 0x00
+        // Page2 : control / status:    16 bit per channel
+        // Page3 : alarm settings:      16 bit per channel
+        // Page3 : factory calibration
+
+        page_crc_t page_crc; // page-aligned reads send the stored crc
+    };
+
+    DoubleBuffer<Memory> memory; // setters publish a complete copy, crcs included
+
+    static void correctMemory(Memory &mem);
+
+    SampleRequest<> sample; // channel 0 - 3: A - D
 
 public:
     static constexpr uint8_t family_code = 0x20;
@@ -38,6 +51,16 @@ public:
     bool     setPotentiometer(const uint16_t p1, const uint16_t p2, const uint16_t p3, const uint16_t p4);
     bool     setPotentiometer(const uint8_t channel, const uint16_t value);
     uint16_t getPotentiometer(const uint8_t channel) const;
+
+    void     updateCRC(void); // recalculates the page-crcs the master made dirty (on a shadow-copy), call it in loop() next to poll(), so read memory sends them right away
+
+    bool     setProvider(const SampleProvider provider, void * const context = nullptr); // only with PROVIDER_ENABLE, convert asks for every selected channel, answer with setPotentiometer()
+
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // the published memory with its crcs, a restore needs no recalculation
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
 };
 
 #endif
@@ -1,29 +1,22 @@
 #include "DS2502.h"
 
-DS2502::DS2502(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
+template <uint8_t PAGES, uint8_t FAMILY>
+DS2502Model<PAGES, FAMILY>::DS2502Model(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
 {
     static_assert(MEM_SIZE < 256, "Implementation does not cover the whole address-space");
 
+    static_assert(PAGE_COUNT <= PAGE_COUNT_STATUS, "Status-bytes cover only 4 pages");
+
+    // code written for the runtime-sized ds2502 keeps working, e.g. DS2502(0x11, ...) is still a ds2501
+    mem_size = ((ID1 == 0x11) || (ID1 == 0x91)) ? uint8_t(2 * PAGE_SIZE) : MEM_SIZE;
+    if (mem_size > MEM_SIZE) mem_size = MEM_SIZE;
+
     clearMemory();
     clearStatus();
-
-    if ((ID1 == 0x11) || (ID1 == 0x91))
-    {
-        // when set to DS2501, the upper two memory pages are not accessible, always read 0xFF
-        for (uint8_t page = 2; page < PAGE_COUNT; ++page)
-        {
-            setPageUsed(page);
-            setPageProtection(page);
-            sizeof_memory = 64;
-        };
-    }
-    else
-    {
-        sizeof_memory = 128;    // must be DS2502 then
-    };
 };
 
-void DS2502::duty(OneWireHub * const hub)
+template <uint8_t PAGES, uint8_t FAMILY>
+void DS2502Model<PAGES, FAMILY>::duty(OneWireHub * const hub)
 {
     uint8_t  reg_TA[2], cmd, data, crc = 0; // Target address, redirected address, command, data, crc
 
@@ -41,11 +34,11 @@ void DS2502::duty(OneWireHub * const hub)
             if (hub->send(&crc))        break;
 
             crc = 0; // reInit CRC and send data
-            for (uint8_t i = reg_TA[0]; i < sizeof_memory; ++i)
+            for (uint8_t i = reg_TA[0]; i < mem_size; ++i)
             {
-                const uint8_t reg_RA = translateRedirection(i);
-                if (hub->send(&memory[reg_RA])) return;
-                crc = crc8(&memory[reg_RA],1,crc);
+                data = memory.read(translateRedirection(i));
+                if (hub->send(&data)) return;
+                crc = crc8(&data,1,crc);
             };
             hub->send(&crc);
             break; // datasheet says we should return all 1s, send(255), till reset, nothing to do here, 1s are passive
@@ -53,15 +46,26 @@ void DS2502::duty(OneWireHub * const hub)
         case 0xC3:      // READ DATA (like 0xF0, but repeatedly till the end of page with following CRC)
             if (hub->send(&crc)) break;
 
-            while (reg_TA[0] < sizeof_memory)
+            while (reg_TA[0] < mem_size)
             {
                 crc = 0; // reInit CRC and send data
                 const uint8_t reg_EA = (reg_TA[0] & ~PAGE_MASK) + PAGE_SIZE; // End Address
-                for (uint8_t i = reg_TA[0]; i < reg_EA; ++i)
+                const uint8_t page   = translateRedirection(reg_TA[0]) / PAGE_SIZE;
+                const bool    whole  = (reg_TA[0] & PAGE_MASK) == 0;
+
+                if (whole && page_crc.getCRC(page, crc))
                 {
-                    const uint8_t reg_RA = translateRedirection(i);
-                    if (hub->send(&memory[reg_RA])) return;
-                    crc = crc8(&memory[reg_RA], 1, crc);
+                    if (hub->send(memory.getPage(page), PAGE_SIZE)) return;
+                }
+                else
+                {
+                    for (uint8_t i = reg_TA[0]; i < reg_EA; ++i)
+                    {
+                        data = memory.read(translateRedirection(i));
+                        if (hub->send(&data)) return;
+                        crc = crc8(&data, 1, crc);
+                    };
+                    if (whole) page_crc.setCRC(page, crc);
                 };
 
                 if (hub->send(&crc)) break;
@@ -82,7 +86,7 @@ void DS2502::duty(OneWireHub * const hub)
             break; // datasheet says we should return all 1s, send(255), till reset, nothing to do here, 1s are passive
 
         case 0x0F:      // WRITE MEMORY
-            while (reg_TA[0] < sizeof_memory)
+            while (reg_TA[0] < mem_size)
             {
                 if (hub->recv(&data))       break;
                 crc = crc8(&data,1,crc);
@@ -90,17 +94,20 @@ void DS2502::duty(OneWireHub * const hub)
                 if (hub->send(&crc))        break;
 
                 const uint8_t reg_RA = translateRedirection(reg_TA[0]);
+                const uint8_t page   = reg_RA / PAGE_SIZE;
 
-                if (getPageProtection(reg_TA[0]))
+                if (getPageProtection(page))
                 {
                     const uint8_t mem_zero = 0x00; // send dummy data
                     if (hub->send(&mem_zero)) break;
                 }
                 else
                 {
-                    memory[reg_RA] &= data; // EPROM-Mode
-                    setPageUsed(reg_RA);
-                    if (hub->send(&memory[reg_RA])) break;
+                    data &= memory.read(reg_RA); // EPROM-Mode
+                    memory.write(reg_RA, data);
+                    page_crc.setDirty(reg_RA, 1);
+                    setPageUsed(page);
+                    if (hub->send(&data)) break;
                 };
                 crc = ++reg_TA[0];
             };
@@ -127,31 +134,52 @@ void DS2502::duty(OneWireHub * const hub)
     };
 };
 
-uint8_t DS2502::translateRedirection(const uint8_t source_address) const
+template <uint8_t PAGES, uint8_t FAMILY>
+uint8_t DS2502Model<PAGES, FAMILY>::translateRedirection(const uint8_t source_address) const
 {
     const uint8_t  source_page    = static_cast<uint8_t >(source_address >> 5);
-    const uint8_t  destin_page    = getPageRedirection(source_page);
-    if (destin_page == 0x00)        return source_address;
+    const uint16_t destin_page    = redirection.getPage(source_page); // whole chain, the redirection is recursive
+    if (destin_page == source_page) return source_address;
+    if (destin_page >= PAGE_COUNT)  return source_address; // the master can write any page into the status
     const uint8_t destin_address  = (source_address & PAGE_MASK) | (destin_page << 5);
     return destin_address;
 };
 
-void DS2502::clearMemory(void)
+template <uint8_t PAGES, uint8_t FAMILY>
+void DS2502Model<PAGES, FAMILY>::updateRedirection(void)
+{
+    redirection.update(&status[STATUS_PG_REDIR]);
+};
+
+template <uint8_t PAGES, uint8_t FAMILY>
+void DS2502Model<PAGES, FAMILY>::clearMemory(void)
 {
-    memset(memory, static_cast<uint8_t>(0xFF), MEM_SIZE);
+    memory.fill(0xFF);
+    page_crc.setDirty();
+    page_crc.update(memory);
 };
 
-void DS2502::clearStatus(void)
+template <uint8_t PAGES, uint8_t FAMILY>
+void DS2502Model<PAGES, FAMILY>::clearStatus(void)
 {
     memset(status, static_cast<uint8_t>(0xFF), STATUS_SIZE);
     status[STATUS_FACTORYP] = 0x00; // last byte should be always zero
+
+    for (uint8_t page = mem_size / PAGE_SIZE; page < PAGE_COUNT_STATUS; ++page) // pages the device does not have (DS2501) are used and protected
+    {
+        status[STATUS_WP_PAGES] &= ~uint8_t((1<<page) | (1<<(page+4)));
+    };
+    updateRedirection();
 };
 
-bool DS2502::writeMemory(const uint8_t* const source, const uint8_t length, const uint8_t position)
+template <uint8_t PAGES, uint8_t FAMILY>
+bool DS2502Model<PAGES, FAMILY>::writeMemory(const uint8_t* const source, const uint8_t length, const uint8_t position)
 {
     if (position >= MEM_SIZE) return false;
     const uint16_t _length = (position + length >= MEM_SIZE) ? (MEM_SIZE - position) : length;
-    memcpy(&memory[position],source,_length);
+    memory.write(position,source,_length);
+    page_crc.setDirty(position, _length);
+    page_crc.update(memory);
 
     const uint8_t page_start = static_cast<uint8_t>(position >> 5);
     const uint8_t page_stop  = static_cast<uint8_t>((position + _length) >> 5);
@@ -160,62 +188,134 @@ bool DS2502::writeMemory(const uint8_t* const source, const uint8_t length, cons
     return (_length==length);
 };
 
-bool DS2502::readMemory(uint8_t* const destination, const uint8_t length, const uint8_t position) const
+template <uint8_t PAGES, uint8_t FAMILY>
+bool DS2502Model<PAGES, FAMILY>::readMemory(uint8_t* const destination, const uint8_t length, const uint8_t position) const
 {
     if (position >= MEM_SIZE) return false;
     const uint16_t _length = (position + length >= MEM_SIZE) ? (MEM_SIZE - position) : length;
-    memcpy(destination,&memory[position],_length);
+    memory.read(position,destination,_length);
     return (_length==length);
 };
 
+template <uint8_t PAGES, uint8_t FAMILY>
+bool DS2502Model<PAGES, FAMILY>::setImage(const uint8_t image[])
+{
+    if (!memory.setImage(image)) return false;
+    page_crc.setDirty();
+    page_crc.update(memory);
 
-uint8_t DS2502::writeStatus(const uint8_t address, const uint8_t value)
+    for (uint8_t page = 0; page < PAGE_COUNT; ++page) // programmed pages are marked as used
+    {
+        const uint8_t * const data = memory.getPage(page);
+        for (uint8_t i = 0; i < PAGE_SIZE; ++i)
+        {
+            if (data[i] != 0xFF) { setPageUsed(page); break; };
+        };
+    };
+    return true;
+};
+
+template <uint8_t PAGES, uint8_t FAMILY>
+void DS2502Model<PAGES, FAMILY>::updateCRC(void)
+{
+    page_crc.update(memory);
+};
+
+
+template <uint8_t PAGES, uint8_t FAMILY>
+uint8_t DS2502Model<PAGES, FAMILY>::writeStatus(const uint8_t address, const uint8_t value)
 {
     if (address < STATUS_UNDEF_B1)  status[address] &= value; // writing is allowed only here
+    if ((address >= STATUS_PG_REDIR) && (address < STATUS_UNDEF_B1)) updateRedirection();
     return status[address];
 };
 
-uint8_t DS2502::readStatus(const uint8_t address) const
+template <uint8_t PAGES, uint8_t FAMILY>
+uint8_t DS2502Model<PAGES, FAMILY>::readStatus(const uint8_t address) const
 {
     if (address >= STATUS_SIZE)     return 0xFF;
     return status[address];
 };
 
 
-void DS2502::setPageProtection(const uint8_t page)
+template <uint8_t PAGES, uint8_t FAMILY>
+void DS2502Model<PAGES, FAMILY>::setPageProtection(const uint8_t page)
 {
     if (page < PAGE_COUNT)          status[STATUS_WP_PAGES] &= ~(uint8_t(1<<page));
 };
 
-bool DS2502::getPageProtection(const uint8_t page) const
+template <uint8_t PAGES, uint8_t FAMILY>
+bool DS2502Model<PAGES, FAMILY>::getPageProtection(const uint8_t page) const
 {
     if (page >= PAGE_COUNT) return true;
+    if (!memory.isWritable(page)) return true; // overlay of the flash-image is exhausted
     return !(status[STATUS_WP_PAGES] & uint8_t(1<<page));
 };
 
-void DS2502::setPageUsed(const uint8_t page)
+template <uint8_t PAGES, uint8_t FAMILY>
+void DS2502Model<PAGES, FAMILY>::setPageUsed(const uint8_t page)
 {
     if (page < PAGE_COUNT)  status[STATUS_WP_PAGES] &= ~(uint8_t(1<<(page+4)));
 };
 
-bool DS2502::getPageUsed(const uint8_t page) const
+template <uint8_t PAGES, uint8_t FAMILY>
+bool DS2502Model<PAGES, FAMILY>::getPageUsed(const uint8_t page) const
 {
     if (page >= PAGE_COUNT) return true;
     return !(status[STATUS_WP_PAGES] & uint8_t(1<<(page+4)));
 };
 
 
-bool DS2502::setPageRedirection(const uint8_t page_source, const uint8_t page_destin)
+template <uint8_t PAGES, uint8_t FAMILY>
+bool DS2502Model<PAGES, FAMILY>::setPageRedirection(const uint8_t page_source, const uint8_t page_destin)
 {
     if (page_source >= PAGE_COUNT)  return false; // really available
     if (page_destin >= PAGE_COUNT)  return false; // virtual mem of the device
 
     status[page_source + STATUS_PG_REDIR] = (page_destin == page_source) ? uint8_t(0xFF) : ~page_destin; // datasheet dictates this, so no page can be redirected to page 0
+    updateRedirection();
     return true;
 };
 
-uint8_t DS2502::getPageRedirection(const uint8_t page) const
+template <uint8_t PAGES, uint8_t FAMILY>
+uint8_t DS2502Model<PAGES, FAMILY>::getPageRedirection(const uint8_t page) const // only the first hop, as stored in the status
 {
     if (page >= PAGE_COUNT) return 0x00;
-    return ~(status[page + STATUS_PG_REDIR]); // TODO: maybe invert this in ReadStatus and safe some Operations? Redirection is critical and often done
+    return ~(status[page + STATUS_PG_REDIR]);
+};
+
+#if STATE_ENABLE
+template <uint8_t PAGES, uint8_t FAMILY>
+uint16_t DS2502Model<PAGES, FAMILY>::getStateSize(void) const
+{
+    return STATUS_SIZE + MEM_SIZE;
 };
+
+template <uint8_t PAGES, uint8_t FAMILY>
+void DS2502Model<PAGES, FAMILY>::readState(const uint16_t position, uint8_t destination[], const uint8_t length) const
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        const uint16_t address = position + i;
+        destination[i] = (address < STATUS_SIZE) ? status[address] : memory.read(address - STATUS_SIZE);
+    };
+};
+
+template <uint8_t PAGES, uint8_t FAMILY>
+void DS2502Model<PAGES, FAMILY>::writeState(const uint16_t position, const uint8_t source[], const uint8_t length)
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        const uint16_t address = position + i;
+        if (address < STATUS_SIZE)  status[address] = source[i]; // not writeStatus(), the eprom-rules do not apply to a restore
+        else                        memory.write(address - STATUS_SIZE, source[i]);
+    };
+    if (position < STATUS_SIZE) updateRedirection();
+    page_crc.setDirty();
+    page_crc.update(memory);
+};
+#endif
+
+// the real devices
+template class DS2502Model<2, 0x11>; // DS2501
+template class DS2502Model<4, 0x09>; // DS2502
@@ -7,11 +7,16 @@
 
 #include "OneWireItem.h"
 
-class DS2502 : public OneWireItem
+// PAGES and FAMILY select the emulated device (see the aliases below), memory and loops are sized by the compiler
+// the status-bytes keep the layout of 4 pages, missing pages read as used and protected
+// like before the templates, ID1 0x11 or 0x91 turns a DS2502 into a ds2501 on the bus, but not in RAM - the DS2501 alias saves it
+template <uint8_t PAGES, uint8_t FAMILY>
+class DS2502Model : public OneWireItem
 {
 private:
 
-    static constexpr uint8_t    PAGE_COUNT          { 4 };
+    static constexpr uint8_t    PAGE_COUNT          { PAGES };
+    static constexpr uint8_t    PAGE_COUNT_STATUS   { 4 };
     static constexpr uint8_t    PAGE_SIZE           { 32 }; // bytes
     static constexpr uint8_t    PAGE_MASK           { PAGE_SIZE - 1 };
 
@@ -25,17 +30,27 @@ private:
     static constexpr uint8_t    STATUS_UNDEF_B1     {0x05}; // 2 byte -> reserved / undefined
     static constexpr uint8_t    STATUS_FACTORYP     {0x07}; // 2 byte -> factoryprogrammed 0x00
 
-    uint8_t  memory[MEM_SIZE];    // 4 pages of 32 bytes
+#if FLASH_IMAGE_ENABLE
+    using storage_t = PagePool<MEM_SIZE, PAGE_SIZE, IMAGE_OVERLAY_SIZE>; // flash-image, written pages hold image AND data
+#else
+    using storage_t = MemoryStorage<MEM_SIZE, PAGE_SIZE>;
+#endif
+
+    storage_t memory;             // PAGE_COUNT pages of 32 bytes
     uint8_t  status[STATUS_SIZE]; // eprom status bytes:
-    uint8_t  sizeof_memory;       // device specific "real" size
+    uint8_t  mem_size;            // MEM_SIZE, 64 if ID1 names a ds2501 (see constructor)
+
+    PageCRC<uint8_t, PAGE_COUNT, PAGE_SIZE> page_crc; // read data sends the stored crc of each page
+    PageRedirection<PAGE_COUNT> redirection;          // resolved chains of the redirection-bytes, updated when they change
 
     uint8_t  translateRedirection(const uint8_t source_address) const;
+    void     updateRedirection(void);
 
 public:
 
-    static constexpr uint8_t family_code = 0x09; // the ds2502
+    static constexpr uint8_t family_code = FAMILY;
 
-    DS2502(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
+    DS2502Model(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
 
     void    duty(OneWireHub * const hub);
 
@@ -44,6 +59,8 @@ public:
 
     bool    writeMemory(const uint8_t* const source, const uint8_t length, const uint8_t position = 0);
     bool    readMemory(uint8_t * const destination, const uint8_t length, const uint8_t position = 0) const;
+    bool    setImage(const uint8_t image[]); // PROGMEM-array of 128 bytes, gets copied to RAM without FLASH_IMAGE_ENABLE
+    void    updateCRC(void);                 // recalculates the page-crcs the master made dirty, call it in loop() next to poll(), so read data sends them right away
 
     uint8_t writeStatus(const uint8_t address, const uint8_t value);
     uint8_t readStatus(const uint8_t address) const;
@@ -56,6 +73,15 @@ public:
 
     bool    setPageRedirection(const uint8_t page_source, const uint8_t page_destin);
     uint8_t getPageRedirection(const uint8_t page) const;
+
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // status-bytes, followed by the memory
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
 };
 
+using DS2501 = DS2502Model<2, 0x11>; // 512bit, also 0x91
+using DS2502 = DS2502Model<4, 0x09>; // 1kbit
+
 #endif
@@ -1,36 +1,24 @@
 #include "DS2506.h"
 
-DS2506::DS2506(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+DS2506Model<PAGES, FAMILY, BACKEND>::DS2506Model(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
 {
-    static_assert(sizeof(memory) <= 0xFFFF, "Implementation does not cover the whole address-space");
+    static_assert(MEM_SIZE <= 0xFFFF, "Implementation does not cover the whole address-space");
 
-    // set device specific "real" sizes
-    switch (ID1)
+    switch (ID1) // code written for the runtime-sized ds2506 keeps working, e.g. DS2506(0x13, ...) is still a ds2503
     {
-        case 0x13:  // DS2503
-            sizeof_memory = 512;
-            break;
-
-        case 0x0B:  // DS2505
-            sizeof_memory = 2048;
-            break;
-
-        case 0x0F:  // DS2506
-            sizeof_memory = 8192;
-            break;
-
-        default:
-            sizeof_memory = 256;
+        case 0x13:  mem_size_dev = 512;  break; // DS2503
+        case 0x0B:  mem_size_dev = 2048; break; // DS2505
+        default:    mem_size_dev = MEM_SIZE_DEV;
     };
-
-    page_count      = sizeof_memory / PAGE_SIZE;                // DS2506: 256
-    status_segment  = page_count / uint8_t(8);                  // DS2506:  32
+    if (mem_size_dev > MEM_SIZE_DEV) mem_size_dev = MEM_SIZE_DEV; // a smaller model can't grow
 
     clearMemory();
     clearStatus();
 };
 
-void DS2506::duty(OneWireHub * const hub)
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+void DS2506Model<PAGES, FAMILY, BACKEND>::duty(OneWireHub * const hub)
 {
     uint16_t reg_TA, reg_RA = 0, crc = 0; // Target address
     uint8_t  cmd, data; // redirected address, command, data, crc
@@ -42,14 +30,14 @@ void DS2506::duty(OneWireHub * const hub)
     switch (cmd)
     {
         case 0xF0:      // READ MEMORY
-            while (reg_TA <= sizeof_memory)
+            while (reg_TA <= mem_size_dev)
             {
                 const uint16_t destin_TA = translateRedirection(reg_TA);
                 const uint8_t  length    = PAGE_SIZE - uint8_t(reg_TA & PAGE_MASK);
 
                 if (destin_TA < MEM_SIZE)
                 {
-                    if (hub->send(&memory[destin_TA],length,crc)) return;
+                    if (hub->send(&memory.getPage(destin_TA / PAGE_SIZE)[destin_TA & PAGE_MASK],length,crc)) return;
                 }
                 else // fake data
                 {
@@ -68,35 +56,10 @@ void DS2506::duty(OneWireHub * const hub)
             break; // datasheet says we should return 1s, till reset, nothing to do here
 
         case 0xA5:      // EXTENDED READ MEMORY (with redirection-information)
-            while (reg_TA <= sizeof_memory)
             {
-                const uint8_t  source_page = static_cast<uint8_t>(reg_TA>>5);
-                const uint8_t  destin_page = getPageRedirection(source_page);
-                if (hub->send(&destin_page,1,crc))                        return;
-                crc = ~crc; // normally crc16 is sent ~inverted
-                hub->send(reinterpret_cast<uint8_t *>(&crc),2); // send crc of (cmd,TA,destin_page) at first, then only crc of (destin_page)
-                crc=0;
-                const uint16_t destin_TA   = translateRedirection(reg_TA);
-                const uint8_t  length      = PAGE_SIZE - uint8_t(reg_TA & PAGE_MASK);
-
-                if (destin_TA < MEM_SIZE)
-                {
-                    if (hub->send(&memory[destin_TA],length,crc)) return;
-                }
-                else // fake data
-                {
-                    data  = 0x00;
-                    uint8_t counter = length;
-                    while (counter--)
-                    {
-                        if (hub->send(&data, 1, crc)) return;
-                    };
-                };
-
-                crc = ~crc; // normally crc16 is sent ~inverted
-                if (hub->send(reinterpret_cast<uint8_t *>(&crc),2)) break;
-                reg_TA += length;
-                crc=0;
+                // crc of (cmd,TA,destin_page) at first, then only crc of (destin_page)
+                ExtendedPageSource source(*this);
+                if (hub->sendPages(source, reg_TA, mem_size_dev, PAGE_SIZE, crc)) return;
             };
             break; // datasheet says we should return 1s, till reset, nothing to do here
 
@@ -118,7 +81,7 @@ void DS2506::duty(OneWireHub * const hub)
             break;
 
         case 0x0F:      // WRITE MEMORY
-            while (reg_TA < sizeof_memory) // check for valid address
+            while (reg_TA < mem_size_dev) // check for valid address
             {
                 if (hub->recv(&data,1,crc)) break;
 
@@ -135,16 +98,19 @@ void DS2506::duty(OneWireHub * const hub)
                 }
                 else
                 {
-                    memory[reg_RA] &= data; // like EEPROM-Mode
+                    data &= memory.read(reg_RA); // like EEPROM-Mode
+                    memory.write(reg_RA, data);
+                    page_crc.setDirty(page);
                     setPageUsed(page);
-                    if (hub->send(&memory[reg_RA])) break;
+                    hub->pushJournal(*this, cmd, reg_RA, &data, 1);
+                    if (hub->send(&data)) break;
                 };
                 crc = ++reg_TA; // prepare new loop
             };
             break;
 
         case 0xF3:      // SPEED WRITE MEMORY, omit CRC
-            while (reg_TA < sizeof_memory) // check for valid address
+            while (reg_TA < mem_size_dev) // check for valid address
             {
                 if (hub->recv(&data)) break;
                 // master issues now a 480us 12V-Programming Pulse
@@ -158,9 +124,12 @@ void DS2506::duty(OneWireHub * const hub)
                 }
                 else
                 {
-                    memory[reg_RA] &= data; // like EEPROM-Mode
+                    data &= memory.read(reg_RA); // like EEPROM-Mode
+                    memory.write(reg_RA, data);
+                    page_crc.setDirty(page);
                     setPageUsed(page);
-                    if (hub->send(&memory[reg_RA])) break;
+                    hub->pushJournal(*this, cmd, reg_RA, &data, 1);
+                    if (hub->send(&data)) break;
                 };
                 ++reg_TA; // prepare new loop
             };
@@ -176,6 +145,7 @@ void DS2506::duty(OneWireHub * const hub)
                 // master issues now a 480us 12V-Programming Pulse
 
                 data = writeStatus(reg_TA, data);
+                hub->pushJournal(*this, cmd, reg_TA, &data, 1);
                 if (hub->send(&data)) break;
                 crc = ++reg_TA; // prepare new loop
             };
@@ -188,6 +158,7 @@ void DS2506::duty(OneWireHub * const hub)
                 // master issues now a 480us 12V-Programming Pulse
 
                 data = writeStatus(reg_TA, data);
+                hub->pushJournal(*this, cmd, reg_TA, &data, 1);
                 if (hub->send(&data)) break;
                 ++reg_TA; // prepare new loop
             };
@@ -198,55 +169,139 @@ void DS2506::duty(OneWireHub * const hub)
     };
 };
 
-void DS2506::clearMemory(void)
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+void DS2506Model<PAGES, FAMILY, BACKEND>::clearMemory(void)
 {
-    memset(memory, static_cast<uint8_t>(0xFF), MEM_SIZE);
+    memory.fill(0xFF);
+    page_crc.setDirty();
+    page_crc.update(memory);
 };
 
-void DS2506::clearStatus(void)
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+void DS2506Model<PAGES, FAMILY, BACKEND>::clearStatus(void)
 {
     memset(status, static_cast<uint8_t>(0xFF), STATUS_SIZE);
+    updateRedirection();
 };
 
-bool DS2506::writeMemory(const uint8_t* const source, const uint16_t length, const uint16_t position)
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+bool DS2506Model<PAGES, FAMILY, BACKEND>::writeMemory(const uint8_t* const source, const uint16_t length, const uint16_t position)
 {
     if (position >= MEM_SIZE) return false;
     const uint16_t _length = (position + length >= MEM_SIZE) ? (MEM_SIZE - position) : length;
-    memcpy(&memory[position],source,_length);
-
     const uint8_t page_start = static_cast<uint8_t>(position >> 5);
     const uint8_t page_stop  = static_cast<uint8_t>((position + _length) >> 5);
+
+    bool writable = true; // a full pool drops the data of new pages
+    for (uint8_t page = page_start; page <= page_stop; page++) writable &= memory.isWritable(page);
+
+    memory.write(position,source,_length);
+    page_crc.setDirty(position, _length);
+    page_crc.update(memory);
+
     for (uint8_t page = page_start; page <= page_stop; page++) setPageUsed(page);
 
-    return (_length==length);
+    return writable && (_length==length);
 };
 
-bool DS2506::readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position) const
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+bool DS2506Model<PAGES, FAMILY, BACKEND>::readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position) const
 {
     if (position >= MEM_SIZE) return false;
     const uint16_t _length = (position + length >= MEM_SIZE) ? (MEM_SIZE - position) : length;
-    memcpy(destination,&memory[position],_length);
+    memory.read(position,destination,_length);
     return (_length==length);
 };
 
-uint16_t DS2506::translateRedirection(const uint16_t source_address) const// TODO: extended read mem description implies that redirection is recursive
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+bool DS2506Model<PAGES, FAMILY, BACKEND>::setBackend(MemoryBackend &backend)
 {
-    const uint8_t  source_page    = static_cast<uint8_t >(source_address >> 5);
-    const uint8_t  destin_page    = getPageRedirection(source_page);
-    if (destin_page == 0x00)        return source_address;
+    if (!memory.setBackend(backend)) return false;
+    page_crc.setDirty();
+    page_crc.update(memory);
+    return true;
+};
+
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+bool DS2506Model<PAGES, FAMILY, BACKEND>::setImage(const uint8_t image[])
+{
+    if (!memory.setImage(image)) return false;
+    page_crc.setDirty();
+    page_crc.update(memory);
+    return true;
+};
+
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+uint8_t DS2506Model<PAGES, FAMILY, BACKEND>::getPoolUsed(void) const
+{
+    return memory.getPoolUsed();
+};
+
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+void DS2506Model<PAGES, FAMILY, BACKEND>::updateCRC(void)
+{
+    page_crc.update(memory);
+};
+
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+const uint8_t * DS2506Model<PAGES, FAMILY, BACKEND>::ExtendedPageSource::getPage(const uint16_t page, const uint8_t page_size) const
+{
+    const uint16_t destin_TA = device.translateRedirection(page * page_size);
+    return (destin_TA < MEM_SIZE) ? device.memory.getPage(destin_TA / PAGE_SIZE) : nullptr; // nullptr: fake data
+};
+
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+bool DS2506Model<PAGES, FAMILY, BACKEND>::ExtendedPageSource::getPrefix(const uint16_t page, uint8_t &prefix) const
+{
+    prefix = device.getPageRedirection(static_cast<uint8_t>(page));
+    return true;
+};
+
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+bool DS2506Model<PAGES, FAMILY, BACKEND>::ExtendedPageSource::getCRC(const uint16_t page, uint16_t &crc) const
+{
+    const uint16_t destin_TA = device.translateRedirection(page * PAGE_SIZE);
+    return device.page_crc.getCRC(destin_TA / PAGE_SIZE, crc); // pages outside of memory are always dirty
+};
+
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+void DS2506Model<PAGES, FAMILY, BACKEND>::ExtendedPageSource::setCRC(const uint16_t page, const uint16_t crc)
+{
+    const uint16_t destin_TA = device.translateRedirection(page * PAGE_SIZE);
+    device.page_crc.setCRC(destin_TA / PAGE_SIZE, crc);
+};
+
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+uint16_t DS2506Model<PAGES, FAMILY, BACKEND>::translateRedirection(const uint16_t source_address) const // follows the whole chain, the redirection is recursive
+{
+    const uint16_t source_page    = source_address >> 5;
+    const uint16_t destin_page    = redirection.getPage(source_page);
+    if (destin_page == source_page) return source_address;
     const uint16_t destin_address = (source_address & PAGE_MASK) | (destin_page << 5);
     return destin_address;
 };
 
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+void DS2506Model<PAGES, FAMILY, BACKEND>::updateRedirection(void)
+{
+    redirection.update(&status[3*STATUS_SEGMENT]);
+};
+
 
-uint8_t DS2506::readStatus(const uint16_t address) const
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+uint8_t DS2506Model<PAGES, FAMILY, BACKEND>::readStatus(const uint16_t address) const
 {
     uint16_t SA = address;
 
     if (address < STATUS_WP_REDIR_BEG)              // is WP_PAGES
     {
         if (SA >= STATUS_SEGMENT) return 0x00;      // emulate protection
-        else                      return status[SA];
+        uint8_t value = status[SA];
+        for (uint8_t bit = 0; bit < 8; ++bit)       // an exhausted pool protects the remaining pages
+        {
+            if (!memory.isWritable((SA << 3) + bit)) value &= ~(uint8_t(1) << bit);
+        };
+        return value;
     }
     else if (address < STATUS_PG_WRITN_BEG)         // is WP_REDIR
     {
@@ -273,7 +328,8 @@ uint8_t DS2506::readStatus(const uint16_t address) const
     else return 0xFF;                               // is undefined
 };
 
-uint8_t DS2506::writeStatus(const uint16_t address, const uint8_t value)
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+uint8_t DS2506Model<PAGES, FAMILY, BACKEND>::writeStatus(const uint16_t address, const uint8_t value)
 {
     uint16_t SA = address;
 
@@ -307,10 +363,12 @@ uint8_t DS2506::writeStatus(const uint16_t address, const uint8_t value)
     else return 0xFF;                               // is undefined
 
     status[SA] &= value;
+    if (SA >= 3*STATUS_SEGMENT) updateRedirection(); // master is in the programming pulse, enough time to resolve the chains
     return status[SA];
 };
 
-void DS2506::setPageProtection(const uint8_t page)
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+void DS2506Model<PAGES, FAMILY, BACKEND>::setPageProtection(const uint8_t page)
 {
     const uint8_t segment_pos = (page>>3);
     if (segment_pos >= STATUS_SEGMENT) return;
@@ -318,15 +376,18 @@ void DS2506::setPageProtection(const uint8_t page)
     status[segment_pos] &= page_mask;
 };
 
-bool DS2506::getPageProtection(const uint8_t page) const
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+bool DS2506Model<PAGES, FAMILY, BACKEND>::getPageProtection(const uint8_t page) const
 {
     const uint8_t segment_pos = (page>>3);
     if (segment_pos >= STATUS_SEGMENT) return true;
+    if (!memory.isWritable(page))      return true; // pool is exhausted
     const uint8_t page_mask = (uint8_t(1)<<(page&7));
     return !(status[segment_pos] & page_mask);
 };
 
-void DS2506::setRedirectionProtection(const uint8_t page)
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+void DS2506Model<PAGES, FAMILY, BACKEND>::setRedirectionProtection(const uint8_t page)
 {
     const uint8_t segment_pos = (page>>3);
     if (segment_pos >= STATUS_SEGMENT) return;
@@ -334,7 +395,8 @@ void DS2506::setRedirectionProtection(const uint8_t page)
     status[STATUS_SEGMENT + segment_pos] &= page_mask;
 };
 
-bool DS2506::getRedirectionProtection(const uint8_t page) const
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+bool DS2506Model<PAGES, FAMILY, BACKEND>::getRedirectionProtection(const uint8_t page) const
 {
     const uint8_t segment_pos = (page>>3);
     if (segment_pos >= STATUS_SEGMENT) return true;
@@ -342,7 +404,8 @@ bool DS2506::getRedirectionProtection(const uint8_t page) const
     return !(status[STATUS_SEGMENT + segment_pos] & page_mask);
 };
 
-void DS2506::setPageUsed(const uint8_t page)
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+void DS2506Model<PAGES, FAMILY, BACKEND>::setPageUsed(const uint8_t page)
 {
     const uint8_t segment_pos = (page>>3);
     if (segment_pos >= STATUS_SEGMENT) return;
@@ -350,7 +413,8 @@ void DS2506::setPageUsed(const uint8_t page)
     status[2*STATUS_SEGMENT + segment_pos] &= page_mask;
 };
 
-bool DS2506::getPageUsed(const uint8_t page) const
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+bool DS2506Model<PAGES, FAMILY, BACKEND>::getPageUsed(const uint8_t page) const
 {
     const uint8_t segment_pos = (page>>3);
     if (segment_pos >= STATUS_SEGMENT) return true;
@@ -358,18 +422,83 @@ bool DS2506::getPageUsed(const uint8_t page) const
     return !(status[2*STATUS_SEGMENT + segment_pos] & page_mask);
 };
 
-bool DS2506::setPageRedirection(const uint8_t page_source, const uint8_t page_destin)
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+bool DS2506Model<PAGES, FAMILY, BACKEND>::setPageRedirection(const uint8_t page_source, const uint8_t page_destin)
 {
     if (page_source >= PAGE_COUNT)  return false; // really available
-    if (page_destin >= page_count)  return false; // virtual mem of the device
+    if (page_destin >= (mem_size_dev / PAGE_SIZE)) return false; // virtual mem of the device
     if (getRedirectionProtection(page_source)) return false;
 
     status[3*STATUS_SEGMENT + page_source] = (page_destin == page_source) ? uint8_t(0xFF) : ~page_destin; // datasheet dictates this, so no page can be redirected to page 0
+    updateRedirection();
     return true;
 };
 
-uint8_t DS2506::getPageRedirection(const uint8_t page) const
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+uint8_t DS2506Model<PAGES, FAMILY, BACKEND>::getPageRedirection(const uint8_t page) const // only the first hop, as sent by extended read
 {
     if (page >= PAGE_COUNT) return 0x00;
-    return ~(status[3*STATUS_SEGMENT + page]); // TODO: maybe invert this in ReadStatus and safe some Operations? Redirection is critical and often done
+    return ~(status[3*STATUS_SEGMENT + page]);
+};
+
+#if STATE_ENABLE
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+uint16_t DS2506Model<PAGES, FAMILY, BACKEND>::getStateSize(void) const
+{
+    return STATUS_SIZE + MEM_SIZE;
 };
+
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+void DS2506Model<PAGES, FAMILY, BACKEND>::readState(const uint16_t position, uint8_t destination[], const uint8_t length) const
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        const uint16_t address = position + i;
+        destination[i] = (address < STATUS_SIZE) ? status[address] : memory.read(address - STATUS_SIZE);
+    };
+};
+
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+void DS2506Model<PAGES, FAMILY, BACKEND>::writeState(const uint16_t position, const uint8_t source[], const uint8_t length)
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        const uint16_t address = position + i;
+        if (address < STATUS_SIZE)  status[address] = source[i]; // not writeStatus(), the eprom-rules do not apply to a restore
+        else                        memory.write(address - STATUS_SIZE, source[i]);
+    };
+    if (position < STATUS_SIZE) updateRedirection();
+    page_crc.setDirty();
+    page_crc.update(memory);
+};
+#endif
+
+#if JOURNAL_ENABLE
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND>
+bool DS2506Model<PAGES, FAMILY, BACKEND>::replayWrite(const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length)
+{
+    if ((command == 0x55) || (command == 0xF5))
+    {
+        for (uint8_t i = 0; i < length; ++i) writeStatus(address + i, data[i]); // data is the result, the and-rule keeps it
+        return true;
+    };
+    if ((command != 0x0F) && (command != 0xF3)) return false;
+    if ((address + length) > MEM_SIZE)          return false;
+
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        const uint8_t page = static_cast<uint8_t>((address + i) >> 5);
+        memory.write(address + i, data[i]); // address is already redirected
+        page_crc.setDirty(page);
+        setPageUsed(page);
+    };
+    page_crc.update(memory);
+    return true;
+};
+#endif
+
+// the real devices, add a line for other sizes
+template class DS2506Model<16,  0x13>; // DS2503
+template class DS2506Model<64,  0x0B>; // DS2505
+template class DS2506Model<256, 0x0F>; // DS2506
+template class DS2506Model<256, 0x0F, true>; // DS2506Backed
@@ -8,16 +8,26 @@
 
 #include "OneWireItem.h"
 
-class DS2506 : public OneWireItem
+// PAGES and FAMILY select the emulated device (see the aliases below), the sizes and masks are constants for the compiler
+// like before the templates, ID1 0x13 (ds2503) or 0x0B (ds2505) shrinks the device on the bus, but not its RAM - the matching alias saves it
+// the RAM follows the device: storage is min(real size, MEM_SIZE_PROPOSE), status-bytes follow the storage
+// BACKEND keeps the memory in a MemoryBackend (see setBackend()) instead of RAM or the PagePool
+template <uint16_t PAGES, uint8_t FAMILY, bool BACKEND = false>
+class DS2506Model : public OneWireItem
 {
 private:
 
     // Problem: atmega has 2kb RAM, this IC offers 8kb
     // Solution: out-of-bound-memory will be constant 0xFF, same for the depending status-registers
-    static constexpr uint16_t MEM_SIZE_PROPOSE  = 256; // TUNE HERE! Give this device as much RAM as your CPU can spare
+    // a MemoryBackend (BACKEND) holds the whole 8kb, only status and page-crc stay in RAM (~900 byte)
+    // the PagePool (PAGE_POOL_ENABLE) offers the whole 8kb too, but only written pages take RAM - status, slot-map and pool cost ~900 byte
+    static constexpr bool     USE_POOL          = PAGE_POOL_ENABLE && !BACKEND;
+    static constexpr uint16_t MEM_SIZE_PROPOSE  = (BACKEND || USE_POOL) ? 8192 : 256; // TUNE HERE! Give this device as much RAM as your CPU can spare
 
     static constexpr uint8_t  PAGE_SIZE         = 32;
-    static constexpr uint16_t PAGE_COUNT        = MEM_SIZE_PROPOSE / PAGE_SIZE;
+    static constexpr uint16_t PAGE_COUNT_DEV    = PAGES;                    // device specific "real" size
+    static constexpr uint16_t MEM_SIZE_DEV      = PAGE_COUNT_DEV * PAGE_SIZE;
+    static constexpr uint16_t PAGE_COUNT        = (MEM_SIZE_DEV < MEM_SIZE_PROPOSE) ? PAGE_COUNT_DEV : (MEM_SIZE_PROPOSE / PAGE_SIZE);
     static constexpr uint8_t  PAGE_MASK         = 0b00011111;
 
     static constexpr uint16_t MEM_SIZE          = PAGE_COUNT * PAGE_SIZE;
@@ -36,20 +46,43 @@ private:
 
     static_assert(MEM_SIZE > 255,       "REAL MEM SIZE IS TOO SMALL");
     static_assert(STATUS_SEGMENT > 0,   "REAL MEM SIZE IS TOO SMALL");
-    static_assert(MEM_SIZE <= 8192,     "REAL MEM SIZE IS TOO BIG, MAX IS 8291 bytes");
+    static_assert(MEM_SIZE_DEV <= 8192, "REAL MEM SIZE IS TOO BIG, MAX IS 8291 bytes");
 
-    uint8_t     memory[MEM_SIZE];    // 4 pages of 32 bytes
+    using storage_t  = typename SelectType<USE_POOL, PagePool<MEM_SIZE, PAGE_SIZE, PAGE_POOL_SIZE>, MemoryStorage<MEM_SIZE, PAGE_SIZE, BACKEND>>::type;
+    using page_crc_t = typename SelectType<USE_POOL, storage_t, PageCRC<uint16_t, PAGE_COUNT, PAGE_SIZE>>::type;
+
+    storage_t   memory;              // PAGE_COUNT pages of 32 bytes
     uint8_t     status[STATUS_SIZE]; // eprom status bytes
+    uint16_t    mem_size_dev;        // MEM_SIZE_DEV, smaller if ID1 names a smaller device (see constructor)
+
+    PageRedirection<PAGE_COUNT> redirection; // resolved chains of the redirection-bytes, updated when they change
+
+    // extended read sends the stored crc of each page, the pool keeps them itself and page_crc becomes a reference
+    typename SelectType<USE_POOL, page_crc_t &, page_crc_t>::type page_crc {memory};
+
+    class ExtendedPageSource : public PageSource // redirection-byte as prefix, followed by the data of the redirected page
+    {
+    private:
+
+        DS2506Model &device;
+
+    public:
+
+        explicit ExtendedPageSource(DS2506Model &ds2506) : PageSource(nullptr, MEM_SIZE), device(ds2506) {};
 
-    uint16_t    sizeof_memory;              // device specific "real" size
-    uint16_t    page_count, status_segment; // device specific "real" size
+        const uint8_t * getPage(const uint16_t page, const uint8_t page_size) const;
+        bool    getPrefix(const uint16_t page, uint8_t &prefix) const;
+        bool    getCRC(const uint16_t page, uint16_t &crc) const;
+        void    setCRC(const uint16_t page, const uint16_t crc);
+    };
 
     uint16_t translateRedirection(const uint16_t source_address) const; // react to redirection in status and not available memory
+    void     updateRedirection(void);
 
 public:
-    static constexpr uint8_t family_code = 0x0F; // the ds2506
+    static constexpr uint8_t family_code = FAMILY;
 
-    DS2506(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
+    DS2506Model(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
 
     void    duty(OneWireHub * const hub);
 
@@ -59,6 +92,11 @@ public:
     bool    writeMemory(const uint8_t* const source, const uint16_t length, const uint16_t position = 0);
     bool    readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position = 0) const;
 
+    bool    setBackend(MemoryBackend &backend); // only for DS2506Backed, call before attach()
+    bool    setImage(const uint8_t image[]);    // PROGMEM-array of the full memory, with PAGE_POOL_ENABLE the pool becomes its overlay
+    uint8_t getPoolUsed(void) const;            // pages taken from the pool, only with PAGE_POOL_ENABLE and without backend
+    void    updateCRC(void);                    // recalculates the page-crcs the master made dirty, call it in loop() next to poll(), so extended read sends them right away
+
     uint8_t writeStatus(const uint16_t address, const uint8_t value);
     uint8_t readStatus(const uint16_t address) const;
 
@@ -73,6 +111,22 @@ public:
 
     bool    setPageRedirection(const uint8_t page_source, const uint8_t page_destin);
     uint8_t getPageRedirection(const uint8_t page) const;
+
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // status-bytes, followed by the memory (prefix-length for attach() keeps only the status)
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
+
+#if JOURNAL_ENABLE
+    bool     replayWrite(const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length); // write memory (0x0F, 0xF3) with the redirected address, write status (0x55, 0xF5)
+#endif
 };
 
+using DS2503 = DS2506Model<16,  0x13>; // 4kbit
+using DS2505 = DS2506Model<64,  0x0B>; // 16kbit
+using DS2506 = DS2506Model<256, 0x0F>; // 64kbit
+
+using DS2506Backed = DS2506Model<256, 0x0F, true>; // 64kbit in a MemoryBackend
+
 #endif
@@ -1,5 +1,16 @@
 #include "DS2890.h"
 
+static constexpr RegisterCommand ds2890_commands[] PROGMEM =
+{
+    // cmd, address bytes, mask, first, last, crc
+    { 0x0F, 0, 0x0000, 0x00, 0x00, CrcMode::NONE }, // WRITE POSITION
+    { 0x55, 0, 0x0000, 0x00, 0x00, CrcMode::NONE }, // WRITE CONTROL REGISTER
+    { 0xAA, 0, 0x0000, 0x00, 0x00, CrcMode::NONE }, // READ CONTROL REGISTER
+    { 0xF0, 0, 0x0000, 0x00, 0x00, CrcMode::NONE }, // READ POSITION
+    { 0xC3, 0, 0x0000, 0x00, 0x00, CrcMode::NONE }, // INCREMENT
+    { 0x99, 0, 0x0000, 0x00, 0x00, CrcMode::NONE }, // DECREMENT
+};
+
 DS2890::DS2890(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
 {
     register_feat = REG_MASK_POTI_CHAR | REG_MASK_WIPER_SET | REG_MASK_POTI_NUMB | REG_MASK_WIPER_POS | REG_MASK_POTI_RESI;
@@ -10,20 +21,28 @@ DS2890::DS2890(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5,
 void DS2890::duty(OneWireHub * const hub)
 {
     const uint8_t poti = register_ctrl&POTI_MASK;
-    uint8_t data, cmd;
+    uint8_t  data, cmd;
+    uint16_t reg_TA; // no command has an address
+
+    RegisterCommand command;
 
     start_over:
 
-    if (hub->recv(&cmd))  return;
+    if (hub->recvCommand(ds2890_commands, sizeof(ds2890_commands)/sizeof(RegisterCommand), command, reg_TA)) return; // no crc on the wire, so none is calculated
 
-    switch (cmd)
+    switch (command.cmd)
     {
         case 0x0F:      // WRITE POSITION
             if (hub->recv(&data))           break;
             if (hub->send(&data))           break;
             if (hub->recv(&cmd))            break;
 
-            if (cmd == RELEASE_CODE) register_poti[poti] = data;
+            if (cmd == RELEASE_CODE)
+            {
+                register_poti[poti] = data;
+                hub->pushEvent(*this, poti, 1, data); // address is the channel
+                hub->pushJournal(*this, command.cmd, poti, &data, 1);
+            };
             break; // respond with 1s ... passive
 
         case 0x55:      // WRITE CONTROL REGISTER
@@ -39,6 +58,7 @@ void DS2890::duty(OneWireHub * const hub)
                 else           data |= 0x08;
 
                 register_ctrl = data;
+                hub->pushJournal(*this, command.cmd, 0, &data, 1);
             };
             break; // respond with 1s ... passive
 
@@ -56,17 +76,64 @@ void DS2890::duty(OneWireHub * const hub)
 
         case 0xC3:      // INCREMENT
             if (register_poti[poti] < 0xFF) register_poti[poti]++;
+            hub->pushJournal(*this, command.cmd, poti, &register_poti[poti], 1);
             if (hub->send(&register_poti[poti])) break;
             break;
 
         case 0x99:      // DECREMENT
             if (register_poti[poti]) register_poti[poti]--;
+            hub->pushJournal(*this, command.cmd, poti, &register_poti[poti], 1);
             if (hub->send(&register_poti[poti])) break;
             break;
+    };
 
-        default:
-            hub->raiseSlaveError(cmd);
+    if ((command.cmd == 0xC3) || (command.cmd == 0x99)) goto start_over; // only for this device -> when INCREMENT or DECREMENT the master can issue another cmd right away
+};
+
+#if STATE_ENABLE
+uint16_t DS2890::getStateSize(void) const
+{
+    return 1 + POTI_SIZE;
+};
+
+void DS2890::readState(const uint16_t position, uint8_t destination[], const uint8_t length) const
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        const uint16_t address = position + i;
+        destination[i] = (address == 0) ? register_ctrl : register_poti[address - 1];
+    };
+};
+
+void DS2890::writeState(const uint16_t position, const uint8_t source[], const uint8_t length)
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        const uint16_t address = position + i;
+        if (address == 0)   register_ctrl = source[i];
+        else                register_poti[address - 1] = source[i];
     };
+};
+#endif
 
-    if ((cmd == 0xC3) || (cmd == 0x99)) goto start_over; // only for this device -> when INCREMENT or DECREMENT the master can issue another cmd right away
+#if JOURNAL_ENABLE
+bool DS2890::replayWrite(const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length)
+{
+    if (length != 1) return false;
+    switch (command)
+    {
+        case 0x0F:      // WRITE POSITION, journaled with the resulting position
+        case 0xC3:      // INCREMENT
+        case 0x99:      // DECREMENT
+            setPotentiometer(static_cast<uint8_t>(address), data[0]);
+            return true;
+
+        case 0x55:      // WRITE CONTROL REGISTER, already decoded
+            register_ctrl = data[0];
+            return true;
+
+        default:
+            return false;
+    };
 };
+#endif
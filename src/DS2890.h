@@ -53,6 +53,16 @@ public:
     {
         return register_feat;
     };
+
+#if JOURNAL_ENABLE
+    bool    replayWrite(const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length); // wiper (0x0F, 0xC3, 0x99) with the channel as address, control register (0x55)
+#endif
+
+#if STATE_ENABLE
+    uint16_t getStateSize(void) const; // control register, followed by the wipers
+    void     readState(const uint16_t position, uint8_t destination[], const uint8_t length) const;
+    void     writeState(const uint16_t position, const uint8_t source[], const uint8_t length);
+#endif
 };
 
 #endif
@@ -0,0 +1,102 @@
+#include "HubDiag.h"
+
+HubDiag::HubDiag(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) : OneWireItem(ID1, ID2, ID3, ID4, ID5, ID6, ID7)
+{
+    static_assert(sizeof(memory) < 65535,  "Implementation does not cover the whole address-space");
+    static_assert(SLOT_TYPE_COUNT * 6 <= PAGE_SIZE, "Timing-Page is too small");
+    refresh_count = 0;
+    clearMemory();
+};
+
+void HubDiag::duty(OneWireHub * const hub)
+{
+    uint16_t reg_TA, crc = 0; // target address
+    uint8_t  cmd;
+
+    if (hub->recv(&cmd,1,crc))  return;
+
+    switch (cmd)
+    {
+        case 0xAA: // READ MEMORY
+            if (hub->recv(reinterpret_cast<uint8_t *>(&reg_TA),2,crc)) return;
+
+            {
+                PageSource source(memory, MEM_SIZE);
+                if (hub->sendPages(source, reg_TA, MEM_SIZE, PAGE_SIZE, crc)) return;
+            };
+            break;
+
+        default:
+            hub->raiseSlaveError(cmd);
+    };
+};
+
+void HubDiag::clearMemory(void)
+{
+    memset(memory, static_cast<uint8_t>(0x00), MEM_SIZE);
+    memory[0] = LAYOUT_VERSION;
+};
+
+void HubDiag::writeValue(const uint16_t position, const uint32_t value, const uint8_t bytes)
+{
+    for (uint8_t i = 0; i < bytes; ++i)
+    {
+        memory[position + i] = static_cast<uint8_t>(value >> (8*i));
+    };
+};
+
+void HubDiag::refresh(const OneWireHub &hub)
+{
+    HubStats stats;
+    const bool stats_valid = hub.getStats(stats);
+
+    // header
+    uint8_t  slave_count = 0;
+    uint32_t error_count = 0;
+    for (uint8_t i = 0; i < HUB_SLAVE_LIMIT; ++i)  if (hub.getSlave(i) != nullptr) slave_count++;
+    for (uint8_t i = 0; i < ERROR_COUNT; ++i)      error_count += stats.errors[i];
+
+    memory[0] = LAYOUT_VERSION;
+    memory[1] = (stats_valid ? 0b0001 : 0) | (PROFILE_ENABLE ? 0b0010 : 0) | (PROBE_ENABLE ? 0b0100 : 0) | (OVERDRIVE_ENABLE ? 0b1000 : 0);
+    memory[2] = slave_count;
+    memory[3] = HUB_SLAVE_LIMIT;
+    memory[4] = static_cast<uint8_t>(hub.getError());
+    writeValue( 8, millis() / 1000, 4);
+    writeValue(12, ++refresh_count, 4); // lets the master detect a stale snapshot
+    writeValue(16, stats.resets, 4);
+    writeValue(20, stats.rom_commands, 4);
+    writeValue(24, stats.searches, 4);
+    writeValue(28, error_count, 4);
+
+    // error-histogram
+    for (uint8_t i = 0; i < ERROR_COUNT; ++i)
+    {
+        writeValue(PAGE_SIZE + (2*i), stats.errors[i], 2);
+    };
+
+    // timing-margins
+    for (uint8_t i = 0; i < SLOT_TYPE_COUNT; ++i)
+    {
+        const SlotType slot_type = static_cast<SlotType>(i);
+        const timeOW_t percentile = hub.getProfilePercentile(slot_type, 1);
+        writeValue((2*PAGE_SIZE) + (4*i), hub.getProfileMinimum(slot_type), 4);
+        writeValue((2*PAGE_SIZE) + (4*SLOT_TYPE_COUNT) + (2*i), (percentile > 0xFFFF) ? 0xFFFF : percentile, 2);
+    };
+
+    // slave-table
+    for (uint8_t i = 0; i < HUB_SLAVE_LIMIT; ++i)
+    {
+        const OneWireItem * const slave = hub.getSlave(i);
+        const uint16_t position = (3*PAGE_SIZE) + (8*i);
+        if (slave == nullptr) memset(&memory[position], static_cast<uint8_t>(0x00), 8);
+        else                  memcpy(&memory[position], slave->ID, 8);
+    };
+};
+
+bool HubDiag::readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position) const
+{
+    if (position >= MEM_SIZE) return false;
+    const uint16_t _length = (position + length >= MEM_SIZE) ? (MEM_SIZE - position) : length;
+    memcpy(destination,&memory[position],_length);
+    return (_length==length);
+};
@@ -0,0 +1,49 @@
+// Diagnostic slave, exposes the health of the hub to the master (no real device, custom family code)
+// works, memory is a snapshot that gets updated by refresh() - call it in loop(), never during poll()
+// readout: READ MEMORY (0xAA) like the DS2450, each page is followed by the inverted crc16 (sendPages())
+// native bus-features: none
+
+#ifndef ONEWIRE_HUBDIAG_H
+#define ONEWIRE_HUBDIAG_H
+
+#include "OneWireItem.h"
+
+class HubDiag : public OneWireItem
+{
+private:
+
+    static constexpr uint8_t  PAGE_SIZE         = 32;
+    static constexpr uint8_t  PAGE_MASK         = 0b00011111;
+
+    static constexpr uint8_t  SLAVES_PER_PAGE   = PAGE_SIZE / 8;
+    static constexpr uint8_t  PAGE_COUNT        = 3 + ((HUB_SLAVE_LIMIT + SLAVES_PER_PAGE - 1) / SLAVES_PER_PAGE);
+    static constexpr uint16_t MEM_SIZE          = PAGE_COUNT * PAGE_SIZE;
+
+    static constexpr uint8_t  LAYOUT_VERSION    = 1;
+
+    uint8_t  memory[MEM_SIZE];
+    // Page0 : header:      version, features, slave count & limit, last error, uptime [s], refresh-, reset-, rom-command-, search- and error-count
+    // Page1 : errors:      16 bit counter per Error
+    // Page2 : timing:      32 bit minimum margin per SlotType [loops], followed by the 16 bit 1%-percentile per SlotType
+    // Page3+: slaves:      ROM of every position in the slave-list, empty positions read as zero
+
+    uint32_t refresh_count;
+
+    void    writeValue(const uint16_t position, const uint32_t value, const uint8_t bytes); // little endian
+
+public:
+
+    static constexpr uint8_t family_code = 0xFD; // not used by maxim, BAE910 sits next to it
+
+    HubDiag(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
+
+    void    duty(OneWireHub * const hub);
+
+    void    clearMemory(void);
+
+    void    refresh(const OneWireHub &hub); // takes a snapshot of the hub, must not be called during bus-activity
+
+    bool    readMemory(uint8_t* const destination, const uint16_t length, const uint16_t position = 0) const;
+};
+
+#endif
@@ -1,9 +1,18 @@
 #include "OneWireHub.h"
 #include "OneWireItem.h"
 
+#if PROBE_ENABLE
+ProbeStats OneWireHub::probe_stats[PROBE_COUNT];
+#endif
+
+uint8_t             OneWireHub::arena[HUB_ARENA_SIZE];
+const OneWireItem * OneWireHub::arena_owner = nullptr;
+
 OneWireHub::OneWireHub(const uint8_t pin)
 {
-    _error = Error::NO_ERROR;
+    _error      = Error::NO_ERROR;
+    _error_cmd  = 0;
+    _error_bit  = 255;
 
     slave_count = 0;
     slave_selected = nullptr;
@@ -12,6 +21,33 @@ OneWireHub::OneWireHub(const uint8_t pin)
     od_mode = false;
 #endif
 
+#if PROFILE_ENABLE
+    profile_search = false;
+    clearProfile();
+#endif
+
+#if STATS_ENABLE
+    clearStats();
+#endif
+
+#if LOG_ENABLE
+    log_dropped_reported = 0;
+#endif
+
+#if JOURNAL_ENABLE
+    static_assert((JOURNAL_SIZE & (JOURNAL_SIZE - 1)) == 0, "JOURNAL_SIZE must be a power of two");
+    static_assert(JOURNAL_SIZE <= 32768, "JOURNAL_SIZE is too big");
+    journal_head         = 0;
+    journal_tail         = 0;
+    journal_sequence     = 0;
+    journal_dropped      = 0;
+#endif
+
+#if PROBE_ENABLE
+    cycleCountInit();
+    clearProbes(); // done by every hub, but there is no better place
+#endif
+
     for (uint8_t i = 0; i < ONEWIRESLAVE_LIMIT; ++i)
     {
         slave_list[i] = nullptr;
@@ -24,13 +60,34 @@ OneWireHub::OneWireHub(const uint8_t pin)
     DIRECT_WRITE_LOW(pin_baseReg, pin_bitMask);
 
     // prepare debug:
-    if (USE_GPIO_DEBUG)
+#if USE_GPIO_DEBUG
+    static_assert((GPIO_DEBUG_PIN_COUNT > 0) && (GPIO_DEBUG_PIN_COUNT <= 4), "GPIO_DEBUG_PIN_COUNT must be 1 to 4");
+    for (uint8_t i = 0; i < GPIO_DEBUG_PIN_COUNT; ++i)
     {
-        debug_bitMask = PIN_TO_BITMASK(GPIO_DEBUG_PIN);
-        debug_baseReg = PIN_TO_BASEREG(GPIO_DEBUG_PIN);
-        pinMode(GPIO_DEBUG_PIN, OUTPUT);
-        DIRECT_WRITE_LOW(debug_baseReg, debug_bitMask);
-    }
+        debug_bitMask[i] = PIN_TO_BITMASK(GPIO_DEBUG_PINS[i]);
+        debug_baseReg[i] = PIN_TO_BASEREG(GPIO_DEBUG_PINS[i]);
+        pinMode(GPIO_DEBUG_PINS[i], OUTPUT);
+        DIRECT_WRITE_LOW(debug_baseReg[i], debug_bitMask[i]);
+    };
+#if defined(DIRECT_WRITE_MASKED)
+    // pins on another port than the first one stay silent
+    debug_portMask = 0;
+    for (uint8_t i = 0; i < GPIO_DEBUG_PIN_COUNT; ++i)
+    {
+        if (debug_baseReg[i] == debug_baseReg[0]) debug_portMask |= debug_bitMask[i];
+    };
+    for (uint8_t code = 0; code < 16; ++code)
+    {
+        debug_code[code] = 0;
+        for (uint8_t i = 0; i < GPIO_DEBUG_PIN_COUNT; ++i)
+        {
+            if (code & (1 << i)) debug_code[code] |= debug_bitMask[i];
+        };
+        debug_code[code] &= debug_portMask;
+    };
+#endif
+    debug_state = 0;
+#endif
 
     static_assert(VALUE_IPL, "Your architecture has not been calibrated yet, please run examples/debug/calibrate_by_bus_timing and report instructions per loop (IPL) to https://github.com/orgua/OneWireHub");
     static_assert(ONEWIRE_TIME_VALUE_MIN>1,"YOUR ARCHITECTURE IS TO SLOW, THIS MAY RESULT IN TIMING-PROBLEMS");
@@ -42,6 +99,32 @@ uint8_t OneWireHub::attach(OneWireItem &sensor)
 {
     if (slave_count >= ONEWIRESLAVE_LIMIT) return 0; // hub is full
 
+    bool inserted;
+    const uint8_t position = insertSlave(sensor, inserted);
+    if (inserted) buildIDTree();
+    return position;
+};
+
+// attach many sensors at once, the search-tree gets built only one time
+uint8_t OneWireHub::attach(OneWireItem * const sensors[], const uint8_t count)
+{
+    uint8_t attached = 0;
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        if (slave_count >= ONEWIRESLAVE_LIMIT) break; // hub is full
+        bool inserted;
+        if (sensors[i] == nullptr) continue;
+        if (insertSlave(*sensors[i], inserted) < ONEWIRESLAVE_LIMIT) attached++;
+    };
+    buildIDTree();
+    return attached;
+};
+
+// store the sensor in the first free position, without building the search-tree
+uint8_t OneWireHub::insertSlave(OneWireItem &sensor, bool &inserted)
+{
+    inserted = false;
+
     // demonstrate an 1ms-Low-State on the debug pin (only if bus stays high during this time)
     // done here because this FN is always called before hub is used
     if (USE_GPIO_DEBUG)
@@ -75,7 +158,7 @@ uint8_t OneWireHub::attach(OneWireItem &sensor)
 
     slave_list[position] = &sensor;
     slave_count++;
-    buildIDTree();
+    inserted = true;
     return position;
 };
 
@@ -102,6 +185,7 @@ bool    OneWireHub::detach(const uint8_t slave_number)
     if (!slave_count)                           return 0;
     if (slave_number >= ONEWIRESLAVE_LIMIT)     return 0;
 
+    if (arena_owner == slave_list[slave_number]) arena_owner = nullptr;
     slave_list[slave_number] = nullptr;
     slave_count--;
     buildIDTree();
@@ -132,6 +216,23 @@ uint8_t OneWireHub::getIndexOfNextSensorInList(const uint8_t index_start) const
     return 0;
 };
 
+const OneWireItem * OneWireHub::getSlave(const uint8_t slave_number) const
+{
+    if (slave_number >= ONEWIRESLAVE_LIMIT) return nullptr;
+    return slave_list[slave_number];
+};
+
+uint8_t * OneWireHub::claimArena(const OneWireItem &owner)
+{
+    arena_owner = &owner;
+    return arena;
+};
+
+bool OneWireHub::ownsArena(const OneWireItem &owner)
+{
+    return (arena_owner == &owner);
+};
+
 // gone through the address, store this result
 uint8_t OneWireHub::getNrOfFirstFreeIDTreeElement(void) const
 {
@@ -223,7 +324,8 @@ uint8_t OneWireHub::buildIDTree(uint8_t position_IDBit, const mask_t mask_slaves
 
 bool OneWireHub::poll(void)
 {
-    _error = Error::NO_ERROR;
+    _error     = Error::NO_ERROR;
+    _error_bit = 255;
 
     while (1)
     {
@@ -231,16 +333,46 @@ bool OneWireHub::poll(void)
         if (slave_count == 0)       return true;
 
         //Once reset is done, go to next step
-        if (checkReset())           return false;
+        if (checkReset())           break;
+        setDebugState(DebugState::RESET);
 
         // Reset is complete, tell the master we are present
-        if (showPresence())         return false;
+        if (showPresence())         break;
+
+#if STATS_ENABLE
+        stats.resets++;
+#endif
 
         //Now that the master should know we are here, we will get a command from the master
-        if (recvAndProcessCmd())    return false;
+        if (recvAndProcessCmd())    break;
 
         // on total success we want to start again, because the next reset could only be ~125 us away
     }
+
+    // outside of bus-activity: slaves finish due work and raise their alarm-flag, so the alarm search only reads it
+    if ((_error != Error::RESET_IN_PROGRESS) && DIRECT_READ(pin_baseReg, pin_bitMask)) // not while the master pulls low, the reset gets measured by the next poll()
+    {
+        for (uint8_t i = 0; i < ONEWIRESLAVE_LIMIT; ++i)
+        {
+            if (slave_list[i] != nullptr) slave_list[i]->updateAlarm();
+        };
+    };
+
+#if STATS_ENABLE
+    const uint8_t error_nr = static_cast<uint8_t>(_error);
+    if ((error_nr != 0) && (error_nr < ERROR_COUNT) && (stats.errors[error_nr] < 0xFFFF)) stats.errors[error_nr]++;
+#endif
+#if USE_GPIO_DEBUG
+    setDebugState(getDebugState(_error));
+#endif
+#if LOG_ENABLE
+    if ((_error != Error::NO_ERROR) && (_error != Error::FIRST_TIMESLOT_TIMEOUT)) // a presence-only reset is OK, it would flood the ring
+    {
+        const bool has_cmd = (_error == Error::INCORRECT_ONEWIRE_CMD) || (_error == Error::INCORRECT_SLAVE_USAGE);
+        pushLog(_error, has_cmd ? _error_cmd : 0, _error_bit);
+    };
+#endif
+    return false;
 }
 
 
@@ -322,7 +454,7 @@ bool OneWireHub::showPresence(void)
     // Master will delay it's "Presence" check (bus-read)  after the reset
     waitLoopsWhilePinIs(ONEWIRE_TIME_PRESENCE_TIMEOUT, true); // no pinCheck demanded, but this additional check can cut waitTime
 
-    if (USE_GPIO_DEBUG) DIRECT_WRITE_HIGH(debug_baseReg, debug_bitMask);
+    setDebugState(DebugState::PRESENCE);
 
     // pull the bus low and hold it some time
     DIRECT_WRITE_LOW(pin_baseReg, pin_bitMask);
@@ -332,10 +464,13 @@ bool OneWireHub::showPresence(void)
 
     DIRECT_MODE_INPUT(pin_baseReg, pin_bitMask);     // allow it to float
 
-    if (USE_GPIO_DEBUG) DIRECT_WRITE_LOW(debug_baseReg, debug_bitMask);
+    setDebugState(DebugState::ROM_CMD);
 
     // When the master or other slaves release the bus within a given time everything is fine
-    if (!waitLoopsWhilePinIs((ONEWIRE_TIME_PRESENCE_MAX[od_mode] - ONEWIRE_TIME_PRESENCE_MIN[od_mode]), false))
+    const timeOW_t loops_remaining = waitLoopsWhilePinIs((ONEWIRE_TIME_PRESENCE_MAX[od_mode] - ONEWIRE_TIME_PRESENCE_MIN[od_mode]), false);
+    profileSlot(SlotType::PRESENCE, loops_remaining);
+
+    if (!loops_remaining)
     {
         _error = Error::PRESENCE_LOW_ON_LINE;
         return true;
@@ -346,6 +481,7 @@ bool OneWireHub::showPresence(void)
 
 void OneWireHub::searchIDTree(void)
 {
+    HUB_PROBE(Probe::SEARCH_ID_TREE);
     uint8_t position_IDBit  = 0;
     uint8_t trigger_pos     = 0;
     uint8_t active_slave    = idTree[trigger_pos].slave_selected;
@@ -399,6 +535,52 @@ void OneWireHub::searchIDTree(void)
     slave_selected = slave_list[active_slave];
 };
 
+// the alarm-subset has no tree: the candidates get narrowed bit by bit, it costs a loop over the alarmed slaves per bit (normally few)
+// hasAlarm() only reads the flag that poll() keeps current with updateAlarm(), nothing gets computed before the first bit slot
+void OneWireHub::searchAlarm(void)
+{
+    uint8_t candidate[ONEWIRESLAVE_LIMIT];
+    uint8_t candidate_count = 0;
+
+    for (uint8_t i = 0; i < ONEWIRESLAVE_LIMIT; ++i)
+    {
+        if ((slave_list[i] != nullptr) && slave_list[i]->hasAlarm()) candidate[candidate_count++] = i;
+    };
+
+    if (candidate_count == 0) return; // nobody answers, the master reads 1s
+
+    for (uint8_t position_IDBit = 0; position_IDBit < 64; ++position_IDBit)
+    {
+        const uint8_t pos_byte = (position_IDBit >> 3);
+        const uint8_t mask_bit = (static_cast<uint8_t>(1) << (position_IDBit & (7)));
+
+        bool got_zero = false;
+        bool got_one  = false;
+        for (uint8_t i = 0; i < candidate_count; ++i)
+        {
+            if (slave_list[candidate[i]]->ID[pos_byte] & mask_bit)  got_one  = true;
+            else                                                    got_zero = true;
+        };
+
+        // wired-and of all candidates: bit, then complement
+        if (sendBit(!got_zero)) return;
+        if (sendBit(!got_one))  return;
+
+        const bool bit_recv = recvBit();
+        if (_error != Error::NO_ERROR)  return;
+
+        uint8_t remaining = 0;
+        for (uint8_t i = 0; i < candidate_count; ++i)
+        {
+            if (((slave_list[candidate[i]]->ID[pos_byte] & mask_bit) != 0) == bit_recv) candidate[remaining++] = candidate[i];
+        };
+        candidate_count = remaining;
+        if (candidate_count == 0) return;
+    };
+
+    slave_selected = slave_list[candidate[0]];
+};
+
 bool OneWireHub::recvAndProcessCmd(void)
 {
     uint8_t address[8], cmd;
@@ -409,11 +591,25 @@ bool OneWireHub::recvAndProcessCmd(void)
     if (_error == Error::RESET_IN_PROGRESS) return false; // stay in poll()-loop and trigger another datastream-detection
     if (_error != Error::NO_ERROR)          return true;
 
+#if STATS_ENABLE
+    stats.rom_commands++;
+#endif
+
     switch (cmd)
     {
         case 0xF0: // Search rom
             slave_selected = nullptr;
+            setDebugState(DebugState::SEARCH);
+#if STATS_ENABLE
+            stats.searches++;
+#endif
+#if PROFILE_ENABLE
+            profile_search = true;
+            searchIDTree();
+            profile_search = false;
+#else
             searchIDTree();
+#endif
             return false; // always trigger a re-init after searchIDTree
 
         case 0x69: // overdrive MATCH ROM
@@ -458,7 +654,8 @@ bool OneWireHub::recvAndProcessCmd(void)
 
             if (slave_selected != nullptr)
             {
-                if (USE_GPIO_DEBUG) DIRECT_WRITE_HIGH(debug_baseReg, debug_bitMask);
+                setDebugState(DebugState::DUTY);
+                HUB_PROBE(Probe::DUTY);
                 slave_selected->duty(this);
             };
             break;
@@ -478,7 +675,8 @@ bool OneWireHub::recvAndProcessCmd(void)
             }
             if (slave_selected != nullptr)
             {
-                if (USE_GPIO_DEBUG) DIRECT_WRITE_HIGH(debug_baseReg, debug_bitMask);
+                setDebugState(DebugState::DUTY);
+                HUB_PROBE(Probe::DUTY);
                 slave_selected->duty(this);
             };
             break;
@@ -499,14 +697,22 @@ bool OneWireHub::recvAndProcessCmd(void)
             return false;
 
         case 0xEC: // ALARM SEARCH
-            // TODO: Alarm searchIDTree command, respond if flag is set
             // is like searchIDTree-rom, but only slaves with triggered alarm will appear
-            break;
+            slave_selected = nullptr;
+            setDebugState(DebugState::SEARCH);
+#if STATS_ENABLE
+            stats.searches++;
+#endif
+            searchAlarm();
+            return false; // always trigger a re-init after searchAlarm
 
         case 0xA5: // RESUME COMMAND
             if (slave_selected == nullptr) return true;
-            if (USE_GPIO_DEBUG) DIRECT_WRITE_HIGH(debug_baseReg, debug_bitMask);
-            slave_selected->duty(this);
+            setDebugState(DebugState::DUTY);
+            {
+                HUB_PROBE(Probe::DUTY);
+                slave_selected->duty(this);
+            };
             break;
 
         default: // Unknown command
@@ -522,6 +728,7 @@ bool OneWireHub::recvAndProcessCmd(void)
 // info: check for errors after calling and break/return if possible, returns true if error is detected
 bool OneWireHub::sendBit(const bool value)
 {
+    HUB_PROBE(Probe::SEND_BIT);
     noInterrupts();
     const bool writeZero = !value;
 
@@ -536,9 +743,9 @@ bool OneWireHub::sendBit(const bool value)
     };
 
     // Wait for bus to fall LOW, start of new timeslot
-    retries = ONEWIRE_TIME_MSG_HIGH_TIMEOUT;
-    while ((DIRECT_READ(pin_baseReg, pin_bitMask)) && (--retries));
-    if (!retries)
+    timeOW_t loops_idle = ONEWIRE_TIME_MSG_HIGH_TIMEOUT; // what is left is the margin of this slot
+    while ((DIRECT_READ(pin_baseReg, pin_bitMask)) && (--loops_idle));
+    if (!loops_idle)
     {
         _error = Error::AWAIT_TIMESLOT_TIMEOUT_HIGH;
         interrupts();
@@ -559,6 +766,9 @@ bool OneWireHub::sendBit(const bool value)
     while (!(DIRECT_READ(pin_baseReg, pin_bitMask)) && (--retries)); // TODO: we should check for (!retries) because there could be a reset in progress...
     DIRECT_MODE_INPUT(pin_baseReg, pin_bitMask);
 
+    // measured after the slot is handled, so the profiler itself lowers the margin of the next slot
+    profileSlot(writeZero ? SlotType::WRITE_ZERO : SlotType::WRITE_ONE, ONEWIRE_TIME_MSG_HIGH_TIMEOUT - loops_idle);
+
     return false;
 };
 
@@ -569,9 +779,96 @@ bool OneWireHub::send(const uint8_t address[], const uint8_t data_length)
     noInterrupts();
     DIRECT_WRITE_LOW(pin_baseReg, pin_bitMask);
     DIRECT_MODE_INPUT(pin_baseReg, pin_bitMask);
-    uint8_t bytes_sent = 0;
+    const bool error = sendStream(address, data_length);
+    interrupts();
+    return error;
+};
 
-    for ( ; bytes_sent < data_length; ++bytes_sent)             // loop for sending bytes
+bool OneWireHub::send(const uint8_t address[], const uint8_t data_length, uint16_t &crc16)
+{
+    beginStream();
+    const bool error = sendStream(address, data_length, crc16);
+    endStream();
+    return error;
+};
+
+bool OneWireHub::loadCommand(const RegisterCommand table[], const uint8_t table_size, const uint8_t cmd, RegisterCommand &command)
+{
+    uint8_t index = 0;
+    while (pgm_read_byte(&table[index].cmd) != cmd) // tables are short, the search costs less than a bit-slot
+    {
+        if (++index >= table_size)
+        {
+            raiseSlaveError(cmd);
+            return false;
+        };
+    };
+
+    // only the matching entry gets copied out of flash
+    const uint8_t * const source = reinterpret_cast<const uint8_t *>(&table[index]);
+    uint8_t * const destination  = reinterpret_cast<uint8_t *>(&command);
+    for (uint8_t i = 0; i < sizeof(RegisterCommand); ++i) destination[i] = pgm_read_byte(&source[i]);
+    return true;
+};
+
+bool OneWireHub::recvCommand(const RegisterCommand table[], const uint8_t table_size, RegisterCommand &command, uint16_t &address, uint16_t &crc16)
+{
+    uint8_t cmd;
+    if (recv(&cmd,1,crc16))                                 return true;
+    if (!loadCommand(table, table_size, cmd, command))      return true;
+
+    address = 0;
+    if (command.address_bytes && recv(reinterpret_cast<uint8_t *>(&address),command.address_bytes,crc16)) return true;
+    address &= command.address_mask;
+    return (address < command.first) || (address > command.last);
+};
+
+bool OneWireHub::recvCommand(const RegisterCommand table[], const uint8_t table_size, RegisterCommand &command, uint16_t &address)
+{
+    uint8_t cmd;
+    if (recv(&cmd,1))                                       return true;
+    if (!loadCommand(table, table_size, cmd, command))      return true;
+
+    address = 0;
+    if (command.address_bytes && recv(reinterpret_cast<uint8_t *>(&address),command.address_bytes)) return true;
+    address &= command.address_mask;
+    return (address < command.first) || (address > command.last);
+};
+
+bool OneWireHub::sendRegisters(const RegisterCommand &command, const uint8_t memory[], const uint16_t address, uint16_t &crc16)
+{
+    uint16_t       position = address - command.first;
+    const uint16_t end      = command.last + uint16_t(1) - command.first;
+
+    while (position < end) // send() takes max 255 byte
+    {
+        const uint8_t length = ((end - position) > 0xFF) ? uint8_t(0xFF) : uint8_t(end - position);
+        if (send(&memory[position], length, crc16)) return true;
+        position += length;
+    };
+
+    if (command.crc == CrcMode::NONE) return false;
+    crc16 = ~crc16;
+    return send(reinterpret_cast<uint8_t *>(&crc16),2);
+};
+
+void OneWireHub::beginStream(void)
+{
+    setDebugState(DebugState::CRC);
+    noInterrupts();
+    DIRECT_WRITE_LOW(pin_baseReg, pin_bitMask);
+    DIRECT_MODE_INPUT(pin_baseReg, pin_bitMask);
+};
+
+void OneWireHub::endStream(void)
+{
+    interrupts();
+    setDebugState(DebugState::DUTY); // only slaves use crc16
+};
+
+bool OneWireHub::sendStream(const uint8_t address[], const uint8_t data_length)
+{
+    for (uint8_t bytes_sent = 0; bytes_sent < data_length; ++bytes_sent) // loop for sending bytes
     {
         const uint8_t dataByte = address[bytes_sent];
 
@@ -579,29 +876,20 @@ bool OneWireHub::send(const uint8_t address[], const uint8_t data_length)
         {
             if (sendBit(static_cast<bool>(bitMask & dataByte)))
             {
+                _error_bit = getBitPosition(bitMask);
                 if ((bitMask == 0x01) && (_error == Error::AWAIT_TIMESLOT_TIMEOUT_HIGH)) _error = Error::FIRST_BIT_OF_BYTE_TIMEOUT;
                 interrupts();
                 return true;
             }
         };
-        if (USE_GPIO_DEBUG)
-        {
-            DIRECT_WRITE_HIGH(debug_baseReg, debug_bitMask);
-            DIRECT_WRITE_LOW(debug_baseReg, debug_bitMask);
-        };
+        pulseDebugState();
     };
-    interrupts();
-    return (bytes_sent != data_length);
+    return false;
 };
 
-bool OneWireHub::send(const uint8_t address[], const uint8_t data_length, uint16_t &crc16)
+bool OneWireHub::sendStream(const uint8_t address[], const uint8_t data_length, uint16_t &crc16)
 {
-    noInterrupts();
-    DIRECT_WRITE_LOW(pin_baseReg, pin_bitMask);
-    DIRECT_MODE_INPUT(pin_baseReg, pin_bitMask);
-    uint8_t bytes_sent = 0;
-
-    for ( ; bytes_sent < data_length; ++bytes_sent)             // loop for sending bytes
+    for (uint8_t bytes_sent = 0; bytes_sent < data_length; ++bytes_sent) // loop for sending bytes
     {
         uint8_t dataByte = address[bytes_sent];
 
@@ -609,24 +897,28 @@ bool OneWireHub::send(const uint8_t address[], const uint8_t data_length, uint16
         {
             if (sendBit(static_cast<bool>(0x01 & dataByte)))
             {
+                _error_bit = counter;
                 if ((counter == 0) && (_error ==Error::AWAIT_TIMESLOT_TIMEOUT_HIGH)) _error = Error::FIRST_BIT_OF_BYTE_TIMEOUT;
                 interrupts();
                 return true;
             };
 
-            const uint8_t mix = ((uint8_t) crc16 ^ dataByte) & static_cast<uint8_t>(0x01);
-            crc16 >>= 1;
-            if (mix)  crc16 ^= static_cast<uint16_t>(0xA001);
+            crc16 = crc16Step(crc16, static_cast<bool>(0x01 & dataByte));
             dataByte >>= 1;
         };
-        if (USE_GPIO_DEBUG)
-        {
-            DIRECT_WRITE_HIGH(debug_baseReg, debug_bitMask);
-            DIRECT_WRITE_LOW(debug_baseReg, debug_bitMask);
-        };
+        pulseDebugState();
     };
-    interrupts();
-    return (bytes_sent != data_length);
+    return false;
+};
+
+bool OneWireHub::sendStreamZeros(const uint8_t data_length, uint16_t &crc16)
+{
+    const uint8_t zero = 0x00;
+    for (uint8_t bytes_sent = 0; bytes_sent < data_length; ++bytes_sent)
+    {
+        if (sendStream(&zero, 1, crc16)) return true;
+    };
+    return false;
 };
 
 bool OneWireHub::send(const uint8_t dataByte)
@@ -637,6 +929,7 @@ bool OneWireHub::send(const uint8_t dataByte)
 //
 bool OneWireHub::recvBit(void)
 {
+    HUB_PROBE(Probe::RECV_BIT);
     noInterrupts();
     // Wait for bus to rise HIGH, signaling end of last timeslot
     timeOW_t retries = ONEWIRE_TIME_SLOT_MAX[od_mode];
@@ -649,9 +942,9 @@ bool OneWireHub::recvBit(void)
     };
 
     // Wait for bus to fall LOW, start of new timeslot
-    retries = ONEWIRE_TIME_MSG_HIGH_TIMEOUT;
-    while ((DIRECT_READ(pin_baseReg, pin_bitMask)) && (--retries));
-    if (!retries)
+    timeOW_t loops_idle = ONEWIRE_TIME_MSG_HIGH_TIMEOUT; // what is left is the margin of this slot
+    while ((DIRECT_READ(pin_baseReg, pin_bitMask)) && (--loops_idle));
+    if (!loops_idle)
     {
         _error = Error::AWAIT_TIMESLOT_TIMEOUT_HIGH;
         interrupts();
@@ -662,6 +955,8 @@ bool OneWireHub::recvBit(void)
     retries = ONEWIRE_TIME_READ_MIN[od_mode];
     while (!(DIRECT_READ(pin_baseReg, pin_bitMask)) && (--retries));
 
+    profileSlot(SlotType::READ_SAMPLE, ONEWIRE_TIME_MSG_HIGH_TIMEOUT - loops_idle);
+
     return (retries > 0);
 };
 
@@ -682,6 +977,7 @@ bool OneWireHub::recv(uint8_t address[], const uint8_t data_length)
             if (recvBit())                 value |= bitMask;
             if (_error != Error::NO_ERROR)
             {
+                _error_bit = getBitPosition(bitMask);
                 if ((bitMask == 0x01) && (_error ==Error::AWAIT_TIMESLOT_TIMEOUT_HIGH)) _error = Error::FIRST_BIT_OF_BYTE_TIMEOUT;
                 interrupts();
                 return true;
@@ -690,11 +986,7 @@ bool OneWireHub::recv(uint8_t address[], const uint8_t data_length)
 
         address[bytes_received] = value;
 
-        if (USE_GPIO_DEBUG)
-        {
-            DIRECT_WRITE_HIGH(debug_baseReg, debug_bitMask);
-            DIRECT_WRITE_LOW(debug_baseReg, debug_bitMask);
-        };
+        pulseDebugState();
     };
 
     interrupts();
@@ -705,6 +997,7 @@ bool OneWireHub::recv(uint8_t address[], const uint8_t data_length)
 // should be the prefered function for reads, returns true if error occured
 bool OneWireHub::recv(uint8_t address[], const uint8_t data_length, uint16_t &crc16)
 {
+    setDebugState(DebugState::CRC);
     noInterrupts();
     DIRECT_WRITE_LOW(pin_baseReg, pin_bitMask);
     DIRECT_MODE_INPUT(pin_baseReg, pin_bitMask);
@@ -713,37 +1006,28 @@ bool OneWireHub::recv(uint8_t address[], const uint8_t data_length, uint16_t &cr
     for ( ; bytes_received < data_length; ++bytes_received)
     {
         uint8_t value = 0;
-        uint8_t mix = 0;
         for (uint8_t bitMask = 0x01; bitMask; bitMask <<= 1)
         {
-            if (recvBit())
-            {
-                value |= bitMask;
-                mix = 1;
-            }
-            else mix = 0;
+            const bool bit = recvBit();
+            if (bit) value |= bitMask;
 
             if (_error != Error::NO_ERROR)
             {
+                _error_bit = getBitPosition(bitMask);
                 if ((bitMask == 0x01) && (_error ==Error::AWAIT_TIMESLOT_TIMEOUT_HIGH)) _error = Error::FIRST_BIT_OF_BYTE_TIMEOUT;
                 interrupts();
                 return true;
             };
 
-            mix ^= static_cast<uint8_t>(crc16) & static_cast<uint8_t>(0x01);
-            crc16 >>= 1;
-            if (mix)  crc16 ^= static_cast<uint16_t>(0xA001);
+            crc16 = crc16Step(crc16, bit);
         };
 
         address[bytes_received] = value;
-        if (USE_GPIO_DEBUG)
-        {
-            DIRECT_WRITE_HIGH(debug_baseReg, debug_bitMask);
-            DIRECT_WRITE_LOW(debug_baseReg, debug_bitMask);
-        };
+        pulseDebugState();
     };
 
     interrupts();
+    setDebugState(DebugState::DUTY); // only slaves use crc16
     return (bytes_received != data_length);
 };
 
@@ -779,21 +1063,110 @@ timeOW_t OneWireHub::waitLoopsWhilePinIs(volatile timeOW_t retries, const bool p
     return retries;
 };
 
+DebugState OneWireHub::getDebugState(const Error error)
+{
+    switch (error)
+    {
+        case Error::NO_ERROR:
+        case Error::FIRST_TIMESLOT_TIMEOUT: // is OK
+            return DebugState::IDLE;
+        case Error::WAIT_RESET_TIMEOUT:
+        case Error::VERY_LONG_RESET:
+        case Error::VERY_SHORT_RESET:
+        case Error::PRESENCE_LOW_ON_LINE:
+        case Error::PRESENCE_HIGH_ON_LINE:
+        case Error::RESET_IN_PROGRESS:
+            return DebugState::ERROR_RESET;
+        case Error::INCORRECT_ONEWIRE_CMD:
+        case Error::INCORRECT_SLAVE_USAGE:
+        case Error::TRIED_INCORRECT_WRITE:
+            return DebugState::ERROR_COMMAND;
+        default:
+            return DebugState::ERROR_TIMING;
+    };
+};
+
+// only used on the error-path of send() and recv()
+uint8_t OneWireHub::getBitPosition(const uint8_t bitMask)
+{
+    uint8_t position = 0;
+    for (uint8_t mask = bitMask; mask > 1; mask >>= 1) ++position;
+    return position;
+};
+
+void OneWireHub::profileSlot(const SlotType slot_type, const timeOW_t margin)
+{
+#if PROFILE_ENABLE
+    SlotProfile &slot = profile[static_cast<uint8_t>(profile_search ? SlotType::SEARCH_TRIPLET : slot_type)];
+
+    if (margin < slot.margin_min) slot.margin_min = margin;
+    slot.count++;
+
+    uint8_t position = 0;
+    for (timeOW_t value = margin; value && (position < (PROFILE_BUCKETS - 1)); value >>= 1) ++position;
+
+    if (++slot.bucket[position] == 0xFFFF) // keep the shape of the histogram instead of saturating
+    {
+        for (uint8_t i = 0; i < PROFILE_BUCKETS; ++i) slot.bucket[i] >>= 1;
+    };
+#else
+    (void) slot_type; (void) margin;
+#endif
+};
+
 void OneWireHub::waitLoops1ms(void)
 {
-    if (USE_GPIO_DEBUG)
+#if USE_GPIO_DEBUG
+    constexpr timeOW_t loops_1ms = 1000_us;
+    timeOW_t loops_left = 1;
+    while (loops_left)
     {
-        constexpr timeOW_t loops_1ms = 1000_us;
-        timeOW_t loops_left = 1;
-        while (loops_left)
-        {
-            waitLoopsWhilePinIs(loops_1ms, false);
-            DIRECT_MODE_INPUT(pin_baseReg, pin_bitMask);
-            DIRECT_WRITE_HIGH(debug_baseReg, debug_bitMask);
-            loops_left = waitLoopsWhilePinIs(loops_1ms, true);
-            DIRECT_WRITE_LOW(debug_baseReg, debug_bitMask);
-        };
+        waitLoopsWhilePinIs(loops_1ms, false);
+        DIRECT_MODE_INPUT(pin_baseReg, pin_bitMask);
+        DIRECT_WRITE_HIGH(debug_baseReg[0], debug_bitMask[0]);
+        loops_left = waitLoopsWhilePinIs(loops_1ms, true);
+        DIRECT_WRITE_LOW(debug_baseReg[0], debug_bitMask[0]);
     };
+#endif
+};
+
+void OneWireHub::setDebugState(const DebugState state)
+{
+#if USE_GPIO_DEBUG
+    debug_state = static_cast<uint8_t>(state);
+#if defined(DIRECT_WRITE_MASKED)
+    DIRECT_WRITE_MASKED(debug_baseReg[0], debug_portMask, debug_code[debug_state]);
+#else
+    for (uint8_t i = 0; i < GPIO_DEBUG_PIN_COUNT; ++i)
+    {
+        if (debug_state & (1 << i)) DIRECT_WRITE_HIGH(debug_baseReg[i], debug_bitMask[i]);
+        else                        DIRECT_WRITE_LOW(debug_baseReg[i], debug_bitMask[i]);
+    };
+#endif
+#else
+    (void) state;
+#endif
+};
+
+void OneWireHub::pulseDebugState(void)
+{
+#if USE_GPIO_DEBUG
+#if defined(DIRECT_WRITE_MASKED)
+    DIRECT_WRITE_MASKED(debug_baseReg[0], debug_portMask, debug_code[debug_state ^ 1]);
+    DIRECT_WRITE_MASKED(debug_baseReg[0], debug_portMask, debug_code[debug_state]);
+#else
+    if (debug_state & 1)
+    {
+        DIRECT_WRITE_LOW(debug_baseReg[0], debug_bitMask[0]);
+        DIRECT_WRITE_HIGH(debug_baseReg[0], debug_bitMask[0]);
+    }
+    else
+    {
+        DIRECT_WRITE_HIGH(debug_baseReg[0], debug_bitMask[0]);
+        DIRECT_WRITE_LOW(debug_baseReg[0], debug_bitMask[0]);
+    };
+#endif
+#endif
 };
 
 // this calibration calibrates timing with the longest low-state on the OW-Bus.
@@ -888,31 +1261,588 @@ void OneWireHub::printError(void) const
     if (USE_SERIAL_DEBUG)
     {
         if (_error == Error::NO_ERROR) return;
-        Serial.print("Error: ");
-        if (_error == Error::READ_TIMESLOT_TIMEOUT) Serial.print("read timeslot timeout");
-        else if (_error == Error::WRITE_TIMESLOT_TIMEOUT) Serial.print("write timeslot timeout");
-        else if (_error == Error::WAIT_RESET_TIMEOUT) Serial.print("reset wait timeout");
-        else if (_error == Error::VERY_LONG_RESET) Serial.print("very long reset");
-        else if (_error == Error::VERY_SHORT_RESET) Serial.print("very short reset");
-        else if (_error == Error::PRESENCE_LOW_ON_LINE) Serial.print("presence low on line");
-        else if (_error == Error::READ_TIMESLOT_TIMEOUT_LOW) Serial.print("read timeout low");
-        else if (_error == Error::AWAIT_TIMESLOT_TIMEOUT_HIGH) Serial.print("await timeout high");
-        else if (_error == Error::PRESENCE_HIGH_ON_LINE) Serial.print("presence high on line");
-        else if (_error == Error::INCORRECT_ONEWIRE_CMD) Serial.print("incorrect onewire command");
-        else if (_error == Error::INCORRECT_SLAVE_USAGE) Serial.print("slave was used in incorrect way");
-        else if (_error == Error::TRIED_INCORRECT_WRITE) Serial.print("tried to write in read-slot");
-        else if (_error == Error::FIRST_TIMESLOT_TIMEOUT) Serial.print("found no timeslot after reset / presence (is OK)");
-        else if (_error == Error::FIRST_BIT_OF_BYTE_TIMEOUT) Serial.print("first bit of byte timeout");
-
-        if ((_error == Error::INCORRECT_ONEWIRE_CMD) || (_error == Error::INCORRECT_SLAVE_USAGE))
+        printErrorText(_error, _error_cmd);
+    };
+};
+
+void OneWireHub::printErrorText(const Error error, const uint8_t cmd)
+{
+    Serial.print("Error: ");
+    if (error == Error::READ_TIMESLOT_TIMEOUT) Serial.print("read timeslot timeout");
+    else if (error == Error::WRITE_TIMESLOT_TIMEOUT) Serial.print("write timeslot timeout");
+    else if (error == Error::WAIT_RESET_TIMEOUT) Serial.print("reset wait timeout");
+    else if (error == Error::VERY_LONG_RESET) Serial.print("very long reset");
+    else if (error == Error::VERY_SHORT_RESET) Serial.print("very short reset");
+    else if (error == Error::PRESENCE_LOW_ON_LINE) Serial.print("presence low on line");
+    else if (error == Error::READ_TIMESLOT_TIMEOUT_LOW) Serial.print("read timeout low");
+    else if (error == Error::AWAIT_TIMESLOT_TIMEOUT_HIGH) Serial.print("await timeout high");
+    else if (error == Error::PRESENCE_HIGH_ON_LINE) Serial.print("presence high on line");
+    else if (error == Error::INCORRECT_ONEWIRE_CMD) Serial.print("incorrect onewire command");
+    else if (error == Error::INCORRECT_SLAVE_USAGE) Serial.print("slave was used in incorrect way");
+    else if (error == Error::TRIED_INCORRECT_WRITE) Serial.print("tried to write in read-slot");
+    else if (error == Error::FIRST_TIMESLOT_TIMEOUT) Serial.print("found no timeslot after reset / presence (is OK)");
+    else if (error == Error::FIRST_BIT_OF_BYTE_TIMEOUT) Serial.print("first bit of byte timeout");
+    else if (error == Error::RESET_IN_PROGRESS) Serial.print("reset in progress");
+
+    if ((error == Error::INCORRECT_ONEWIRE_CMD) || (error == Error::INCORRECT_SLAVE_USAGE))
+    {
+        Serial.print(" [0x");
+        Serial.print(cmd, HEX);
+        Serial.println("]");
+    } else
+    {
+        Serial.println("");
+    };
+};
+
+// no formatting, no serial - cheap enough for the hub and for slaves during duty()
+void OneWireHub::pushLog(const Error error, const uint8_t cmd, const uint8_t bit)
+{
+#if LOG_ENABLE
+    LogRecord * const record = log_ring.reserve();
+    if (record == nullptr) return; // ring is full, the oldest records are more valuable
+
+    record->timestamp = micros();
+    record->error     = error;
+    record->cmd       = cmd;
+    record->bit       = bit;
+    record->source    = (slave_selected == nullptr) ? 0 : slave_selected->ID[0];
+    log_ring.commit();
+#else
+    (void) error; (void) cmd; (void) bit;
+#endif
+};
+
+bool OneWireHub::popLog(LogRecord &record)
+{
+#if LOG_ENABLE
+    return log_ring.pop(record);
+#else
+    (void) record;
+    return false;
+#endif
+};
+
+uint16_t OneWireHub::getLogDropped(void) const
+{
+#if LOG_ENABLE
+    return log_ring.getDropped();
+#else
+    return 0;
+#endif
+};
+
+// same kind of ring as the log, the slave only fills the event and the application decides what to do
+void OneWireHub::pushEvent(const OneWireItem &source, const uint16_t address, const uint8_t length, const uint8_t value)
+{
+#if EVENT_ENABLE
+    DeviceEvent * const event = event_ring.reserve();
+    if (event == nullptr) return; // ring is full, the application can still read the current state via getters
+
+    event->source  = &source;
+    event->address = address;
+    event->length  = length;
+    event->value   = value;
+    event_ring.commit();
+#else
+    (void) source; (void) address; (void) length; (void) value;
+#endif
+};
+
+bool OneWireHub::popEvent(DeviceEvent &event)
+{
+#if EVENT_ENABLE
+    return event_ring.pop(event);
+#else
+    (void) event;
+    return false;
+#endif
+};
+
+uint16_t OneWireHub::getEventDropped(void) const
+{
+#if EVENT_ENABLE
+    return event_ring.getDropped();
+#else
+    return 0;
+#endif
+};
+
+// records are packed into a byte-ring, so short writes (one eprom-byte) take only a few bytes
+void OneWireHub::pushJournal(const OneWireItem &source, const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length)
+{
+#if JOURNAL_ENABLE
+    JournalRecord record;
+    record.slave = ONEWIRESLAVE_LIMIT;
+    for (uint8_t i = 0; i < ONEWIRESLAVE_LIMIT; ++i)
+    {
+        if (slave_list[i] == &source) record.slave = i;
+    };
+    if (record.slave >= ONEWIRESLAVE_LIMIT) return;
+    record.command = command;
+
+    uint8_t offset = 0;
+    do // a write longer than a record gets split
+    {
+        record.sequence = journal_sequence++;
+        record.address  = address + offset;
+        record.length   = ((length - offset) < HUB_ARENA_SIZE) ? uint8_t(length - offset) : HUB_ARENA_SIZE;
+        memcpy(record.data, &data[offset], record.length);
+        offset += record.length;
+
+        uint8_t buffer[7 + HUB_ARENA_SIZE];
+        const uint8_t  size = packJournal(record, buffer);
+        const uint16_t head = journal_head;
+        const uint16_t used = (head - journal_tail) & (JOURNAL_SIZE - 1);
+        if ((used + size) >= JOURNAL_SIZE) // ring is full, the gap in the sequence tells the consumer
         {
-            Serial.print(" [0x");
-            Serial.print(_error_cmd, HEX);
-            Serial.println("]");
-        } else
+            if (journal_dropped < 0xFFFF) journal_dropped++;
+            continue;
+        };
+
+        for (uint8_t i = 0; i < size; ++i) journal_ring[(head + i) & (JOURNAL_SIZE - 1)] = buffer[i];
+        journal_head = (head + size) & (JOURNAL_SIZE - 1); // publish only after the record is complete
+    }
+    while (offset < length);
+#else
+    (void) source; (void) command; (void) address; (void) data; (void) length;
+#endif
+};
+
+bool OneWireHub::popJournal(JournalRecord &record)
+{
+#if JOURNAL_ENABLE
+    const uint16_t tail = journal_tail;
+    if (tail == journal_head) return false;
+
+    uint8_t buffer[7 + HUB_ARENA_SIZE];
+    const uint8_t length = journal_ring[(tail + 6) & (JOURNAL_SIZE - 1)];
+    for (uint8_t i = 0; i < (7 + length); ++i) buffer[i] = journal_ring[(tail + i) & (JOURNAL_SIZE - 1)];
+    unpackJournal(buffer, 7 + length, record);
+    journal_tail = (tail + 7 + length) & (JOURNAL_SIZE - 1);
+    return true;
+#else
+    (void) record;
+    return false;
+#endif
+};
+
+uint16_t OneWireHub::getJournalDropped(void) const
+{
+#if JOURNAL_ENABLE
+    return journal_dropped;
+#else
+    return 0;
+#endif
+};
+
+bool OneWireHub::replayJournal(const JournalRecord &record)
+{
+#if JOURNAL_ENABLE
+    if (record.slave >= ONEWIRESLAVE_LIMIT)     return false;
+    if (slave_list[record.slave] == nullptr)    return false;
+    return slave_list[record.slave]->replayWrite(record.command, record.address, record.data, record.length);
+#else
+    (void) record;
+    return false;
+#endif
+};
+
+uint8_t OneWireHub::packJournal(const JournalRecord &record, uint8_t buffer[])
+{
+    const uint8_t length = (record.length < HUB_ARENA_SIZE) ? record.length : HUB_ARENA_SIZE;
+    buffer[0] = record.slave;
+    buffer[1] = record.command;
+    buffer[2] = static_cast<uint8_t>(record.sequence);
+    buffer[3] = static_cast<uint8_t>(record.sequence >> 8);
+    buffer[4] = static_cast<uint8_t>(record.address);
+    buffer[5] = static_cast<uint8_t>(record.address >> 8);
+    buffer[6] = length;
+    memcpy(&buffer[7], record.data, length);
+    return 7 + length;
+};
+
+uint8_t OneWireHub::unpackJournal(const uint8_t buffer[], const uint8_t size, JournalRecord &record)
+{
+    if (size < 7)                   return 0;
+    if (buffer[6] > HUB_ARENA_SIZE) return 0;
+    if (size < (7 + buffer[6]))     return 0;
+    record.slave    = buffer[0];
+    record.command  = buffer[1];
+    record.sequence = uint16_t(buffer[2]) | (uint16_t(buffer[3]) << 8);
+    record.address  = uint16_t(buffer[4]) | (uint16_t(buffer[5]) << 8);
+    record.length   = buffer[6];
+    memcpy(record.data, &buffer[7], record.length);
+    return 7 + record.length;
+};
+
+#if SNAPSHOT_ENABLE
+static constexpr uint8_t SNAPSHOT_MAGIC[4]  = { 'O', 'W', 'H', 'S' };
+static constexpr uint8_t SNAPSHOT_VERSION   = 2;            // 2: volatile state of the devices (getSnapshotSize())
+static constexpr uint8_t SNAPSHOT_HEADER    = 8;
+static constexpr uint8_t SNAPSHOT_SLAVE     = 1 + 8 + 2;    // position, id, state-size
+static constexpr uint8_t SNAPSHOT_CHUNK     = 128;          // the state-hooks take 8bit lengths
+
+static bool equalSnapshot(const uint8_t first[], const uint8_t second[], const uint8_t length)
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        if (first[i] != second[i]) return false;
+    };
+    return true;
+};
+
+static uint16_t crcSnapshot(const uint8_t buffer[], const uint32_t size)
+{
+    uint16_t crc = 0;
+    for (uint32_t position = 0; position < size; position += SNAPSHOT_CHUNK)
+    {
+        const uint8_t length = ((size - position) < SNAPSHOT_CHUNK) ? uint8_t(size - position) : SNAPSHOT_CHUNK;
+        crc = OneWireItem::crc16(&buffer[position], length, crc);
+    };
+    return crc;
+};
+#endif
+
+uint32_t OneWireHub::getSnapshotSize(void) const
+{
+#if SNAPSHOT_ENABLE
+    uint32_t size = SNAPSHOT_HEADER + (4 * ONEWIRE_TREE_SIZE) + 2;
+    for (uint8_t position = 0; position < ONEWIRESLAVE_LIMIT; ++position)
+    {
+        if (slave_list[position] != nullptr) size += SNAPSHOT_SLAVE + slave_list[position]->getSnapshotSize();
+    };
+    return size;
+#else
+    return 0;
+#endif
+};
+
+uint32_t OneWireHub::saveSnapshot(uint8_t buffer[], const uint32_t size) const
+{
+#if SNAPSHOT_ENABLE
+    const uint32_t length = getSnapshotSize();
+    if (length > size) return 0;
+
+    for (uint8_t i = 0; i < 4; ++i) buffer[i] = SNAPSHOT_MAGIC[i];
+    buffer[4] = SNAPSHOT_VERSION;
+    buffer[5] = ONEWIRESLAVE_LIMIT;
+    buffer[6] = slave_count;
+    buffer[7] = ONEWIRE_TREE_SIZE;
+
+    uint32_t cursor = SNAPSHOT_HEADER;
+    for (uint8_t element = 0; element < ONEWIRE_TREE_SIZE; ++element)
+    {
+        buffer[cursor++] = idTree[element].slave_selected;
+        buffer[cursor++] = idTree[element].id_position;
+        buffer[cursor++] = idTree[element].got_zero;
+        buffer[cursor++] = idTree[element].got_one;
+    };
+
+    for (uint8_t position = 0; position < ONEWIRESLAVE_LIMIT; ++position)
+    {
+        const OneWireItem * const slave = slave_list[position];
+        if (slave == nullptr) continue;
+
+        const uint16_t state_size = slave->getSnapshotSize();
+        buffer[cursor++] = position;
+        for (uint8_t i = 0; i < 8; ++i) buffer[cursor++] = slave->ID[i];
+        buffer[cursor++] = static_cast<uint8_t>(state_size);
+        buffer[cursor++] = static_cast<uint8_t>(state_size >> 8);
+        for (uint16_t offset = 0; offset < state_size; offset += SNAPSHOT_CHUNK)
         {
-            Serial.println("");
+            const uint8_t chunk = ((state_size - offset) < SNAPSHOT_CHUNK) ? uint8_t(state_size - offset) : SNAPSHOT_CHUNK;
+            slave->readSnapshot(offset, &buffer[cursor + offset], chunk);
         };
+        cursor += state_size;
+    };
+
+    const uint16_t crc = crcSnapshot(buffer, cursor);
+    buffer[cursor++] = static_cast<uint8_t>(crc);
+    buffer[cursor++] = static_cast<uint8_t>(crc >> 8);
+    return cursor;
+#else
+    (void) buffer;
+    (void) size;
+    return 0;
+#endif
+};
+
+bool OneWireHub::loadSnapshot(const uint8_t buffer[], const uint32_t size)
+{
+#if SNAPSHOT_ENABLE
+    // validate everything first, a failed restore leaves the hub untouched
+    const uint32_t tree_end = SNAPSHOT_HEADER + (4 * ONEWIRE_TREE_SIZE);
+    if (size < (tree_end + 2))                          return false;
+    if (!equalSnapshot(buffer, SNAPSHOT_MAGIC, 4))      return false;
+    if (buffer[4] != SNAPSHOT_VERSION)                  return false;
+    if (buffer[5] != ONEWIRESLAVE_LIMIT)                return false;
+    if (buffer[6] != slave_count)                       return false;
+    if (buffer[7] != ONEWIRE_TREE_SIZE)                 return false;
+
+    uint32_t cursor = tree_end;
+    for (uint8_t slave = 0; slave < slave_count; ++slave)
+    {
+        if ((cursor + SNAPSHOT_SLAVE) > size)           return false;
+        const uint8_t position = buffer[cursor];
+        if (position >= ONEWIRESLAVE_LIMIT)             return false;
+        if (slave_list[position] == nullptr)            return false;
+        if (!equalSnapshot(slave_list[position]->ID, &buffer[cursor + 1], 8)) return false;
+        const uint16_t state_size = uint16_t(buffer[cursor + 9]) | (uint16_t(buffer[cursor + 10]) << 8);
+        if (state_size != slave_list[position]->getSnapshotSize()) return false;
+        cursor += SNAPSHOT_SLAVE + state_size;
+    };
+    if ((cursor + 2) > size)                            return false;
+    const uint16_t crc = uint16_t(buffer[cursor]) | (uint16_t(buffer[cursor + 1]) << 8);
+    if (crc != crcSnapshot(buffer, cursor))             return false;
+
+    // bulk copy: the search-tree fits the same ids, the slaves take their state as it was
+    cursor = SNAPSHOT_HEADER;
+    for (uint8_t element = 0; element < ONEWIRE_TREE_SIZE; ++element)
+    {
+        idTree[element].slave_selected  = buffer[cursor++];
+        idTree[element].id_position     = buffer[cursor++];
+        idTree[element].got_zero        = buffer[cursor++];
+        idTree[element].got_one         = buffer[cursor++];
+    };
+
+    for (uint8_t slave = 0; slave < slave_count; ++slave)
+    {
+        OneWireItem * const item = slave_list[buffer[cursor]];
+        const uint16_t state_size = uint16_t(buffer[cursor + 9]) | (uint16_t(buffer[cursor + 10]) << 8);
+        cursor += SNAPSHOT_SLAVE;
+        for (uint16_t offset = 0; offset < state_size; offset += SNAPSHOT_CHUNK)
+        {
+            const uint8_t chunk = ((state_size - offset) < SNAPSHOT_CHUNK) ? uint8_t(state_size - offset) : SNAPSHOT_CHUNK;
+            item->writeSnapshot(offset, &buffer[cursor + offset], chunk);
+        };
+        cursor += state_size;
+    };
+    return true;
+#else
+    (void) buffer;
+    (void) size;
+    return false;
+#endif
+};
+
+// formats and prints the log, call it from loop() - never during bus-activity
+uint8_t OneWireHub::drainLog(void)
+{
+    uint8_t   count = 0;
+#if LOG_ENABLE
+    LogRecord record;
+
+    while (popLog(record))
+    {
+        Serial.print(record.timestamp);
+        Serial.print("us slave 0x");
+        Serial.print(record.source, HEX);
+        if (record.bit < 8)
+        {
+            Serial.print(" bit ");
+            Serial.print(record.bit);
+        };
+        Serial.print(" ");
+        printErrorText(record.error, record.cmd);
+        count++;
+    };
+
+    const uint16_t dropped = log_ring.getDropped();
+    if (dropped != log_dropped_reported)
+    {
+        Serial.print("log dropped ");
+        Serial.print(uint16_t(dropped - log_dropped_reported));
+        Serial.println(" records");
+        log_dropped_reported = dropped;
+    };
+#endif
+    return count;
+};
+
+void OneWireHub::clearProfile(void)
+{
+#if PROFILE_ENABLE
+    for (uint8_t i = 0; i < SLOT_TYPE_COUNT; ++i)
+    {
+        profile[i].margin_min = TIMEOW_MAX;
+        profile[i].count      = 0;
+        for (uint8_t j = 0; j < PROFILE_BUCKETS; ++j) profile[i].bucket[j] = 0;
+    };
+#endif
+};
+
+uint32_t OneWireHub::getProfileCount(const SlotType slot_type) const
+{
+#if PROFILE_ENABLE
+    return profile[static_cast<uint8_t>(slot_type)].count;
+#else
+    (void) slot_type;
+    return 0;
+#endif
+};
+
+timeOW_t OneWireHub::getProfileMinimum(const SlotType slot_type) const
+{
+#if PROFILE_ENABLE
+    return profile[static_cast<uint8_t>(slot_type)].margin_min;
+#else
+    (void) slot_type;
+    return TIMEOW_MAX;
+#endif
+};
+
+// returns the lower bound of the bucket that holds the given percentile, low percentiles are the interesting ones
+timeOW_t OneWireHub::getProfilePercentile(const SlotType slot_type, const uint8_t percent) const
+{
+#if PROFILE_ENABLE
+    const SlotProfile &slot = profile[static_cast<uint8_t>(slot_type)];
+
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < PROFILE_BUCKETS; ++i) total += slot.bucket[i];
+
+    const uint32_t threshold = ((total * percent) + 99) / 100;
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < PROFILE_BUCKETS; ++i)
+    {
+        sum += slot.bucket[i];
+        if (slot.bucket[i] && (sum >= threshold)) return (i ? (timeOW_t(1) << (i - 1)) : 0);
+    };
+#else
+    (void) slot_type; (void) percent;
+#endif
+    return 0;
+};
+
+void OneWireHub::printProfile(void) const
+{
+    if (USE_SERIAL_DEBUG && PROFILE_ENABLE)
+    {
+        const char * const name[SLOT_TYPE_COUNT] = { "presence : \t", "write zero : \t", "write one : \t", "read sample : \t", "search : \t" };
+
+        Serial.println("TIMING MARGIN per slot (in loops, count / min / 1% / 10% / 50%):");
+        for (uint8_t i = 0; i < SLOT_TYPE_COUNT; ++i)
+        {
+            const SlotType slot_type = static_cast<SlotType>(i);
+            Serial.print(name[i]);
+            Serial.print(getProfileCount(slot_type));
+            Serial.print(" / ");
+            Serial.print(getProfileMinimum(slot_type));
+            Serial.print(" / ");
+            Serial.print(getProfilePercentile(slot_type, 1));
+            Serial.print(" / ");
+            Serial.print(getProfilePercentile(slot_type, 10));
+            Serial.print(" / ");
+            Serial.println(getProfilePercentile(slot_type, 50));
+        };
+        Serial.print("one loop takes ");
+        Serial.print(VALUE_IPL * VALUE1k / microsecondsToClockCycles(1));
+        Serial.println(" nanoseconds");
+        Serial.flush();
+    };
+};
+
+void OneWireHub::clearStats(void)
+{
+#if STATS_ENABLE
+    stats.resets        = 0;
+    stats.rom_commands  = 0;
+    stats.searches      = 0;
+    for (uint8_t i = 0; i < ERROR_COUNT; ++i) stats.errors[i] = 0;
+#endif
+};
+
+bool OneWireHub::getStats(HubStats &destination) const
+{
+#if STATS_ENABLE
+    destination = stats;
+    return true;
+#else
+    destination.resets       = 0;
+    destination.rom_commands = 0;
+    destination.searches     = 0;
+    for (uint8_t i = 0; i < ERROR_COUNT; ++i) destination.errors[i] = 0;
+    return false;
+#endif
+};
+
+void OneWireHub::clearProbes(void)
+{
+#if PROBE_ENABLE
+    for (uint8_t i = 0; i < PROBE_COUNT; ++i)
+    {
+        probe_stats[i].calls      = 0;
+        probe_stats[i].cycles_sum = 0;
+        probe_stats[i].cycles_min = static_cast<cycle_t>(~cycle_t(0));
+        probe_stats[i].cycles_max = 0;
+    };
+#endif
+};
+
+uint32_t OneWireHub::getProbeCalls(const Probe probe)
+{
+#if PROBE_ENABLE
+    return probe_stats[static_cast<uint8_t>(probe)].calls;
+#else
+    (void) probe;
+    return 0;
+#endif
+};
+
+cycle_t OneWireHub::getProbeMinimum(const Probe probe)
+{
+#if PROBE_ENABLE
+    if (probe_stats[static_cast<uint8_t>(probe)].calls) return probe_stats[static_cast<uint8_t>(probe)].cycles_min;
+#else
+    (void) probe;
+#endif
+    return 0;
+};
+
+cycle_t OneWireHub::getProbeMaximum(const Probe probe)
+{
+#if PROBE_ENABLE
+    return probe_stats[static_cast<uint8_t>(probe)].cycles_max;
+#else
+    (void) probe;
+    return 0;
+#endif
+};
+
+cycle_t OneWireHub::getProbeMean(const Probe probe)
+{
+#if PROBE_ENABLE
+    const ProbeStats &stats = probe_stats[static_cast<uint8_t>(probe)];
+    if (stats.calls) return static_cast<cycle_t>(stats.cycles_sum / stats.calls);
+#else
+    (void) probe;
+#endif
+    return 0;
+};
+
+void OneWireHub::printProbes(void)
+{
+    if (USE_SERIAL_DEBUG && PROBE_ENABLE)
+    {
+        const char * const name[PROBE_COUNT] = { "sendBit : \t", "recvBit : \t", "searchIDTree : \t", "crc : \t", "duty : \t" };
+
+        Serial.println("CYCLES per probe (calls / min / mean / max):");
+        for (uint8_t i = 0; i < PROBE_COUNT; ++i)
+        {
+            const Probe probe = static_cast<Probe>(i);
+            Serial.print(name[i]);
+            Serial.print(getProbeCalls(probe));
+            Serial.print(" / ");
+            Serial.print(getProbeMinimum(probe));
+            Serial.print(" / ");
+            Serial.print(getProbeMean(probe));
+            Serial.print(" / ");
+            Serial.println(getProbeMaximum(probe));
+        };
+        Serial.print("one microsecond takes ");
+        Serial.print(microsecondsToClockCycles(1));
+        Serial.println(" cycles");
+        Serial.flush();
     };
 };
 
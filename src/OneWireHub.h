@@ -25,6 +25,14 @@ constexpr timeOW_t timeUsToLoops(const uint16_t time_us)
 
 #include "OneWireHub_config.h" // outsource configfile
 
+// one bit of the crc16 (0xA001, little endian) without a branch, so every slot needs the same time for it
+inline __attribute__((always_inline))
+uint16_t crc16Step(const uint16_t crc, const bool bit)
+{
+    const uint16_t mask = static_cast<uint16_t>(0) - static_cast<uint16_t>((crc ^ static_cast<uint16_t>(bit)) & static_cast<uint16_t>(0x01));
+    return (crc >> 1) ^ (mask & static_cast<uint16_t>(0xA001));
+};
+
 #ifndef HUB_SLAVE_LIMIT
 #error "Slavelimit not defined (why?)"
 #elif (HUB_SLAVE_LIMIT > 32)
@@ -61,13 +69,191 @@ enum class Error : uint8_t {
     RESET_IN_PROGRESS          = 15
 };
 
+constexpr uint8_t ERROR_COUNT       {16};
+
+// bus-statistics of the hub (STATS_ENABLE), see getStats()
+struct HubStats
+{
+    uint32_t resets;                // resets that were answered with a presence pulse
+    uint32_t rom_commands;          // received rom-commands, including search rom
+    uint32_t searches;              // search rom only
+    uint16_t errors[ERROR_COUNT];   // histogram over Error, counted when poll() returns, saturates
+};
+
+// state-codes of the GPIO-debug-port (USE_GPIO_DEBUG), bit 0 is on GPIO_DEBUG_PIN, a finished byte briefly inverts bit 0
+enum class DebugState : uint8_t {
+    IDLE                       = 0,
+    PRESENCE                   = 1, // hub pulls the bus low
+    ROM_CMD                    = 2, // receiving / processing the rom-command
+    DUTY                       = 3, // device-command, duty() of the selected slave
+    SEARCH                     = 4, // searchIDTree()
+    CRC                        = 5, // send() / recv() with crc16
+    RESET                      = 6, // valid reset detected
+    ERROR_TIMING               = 8, // timeslot-errors, set when poll() returns
+    ERROR_RESET                = 9, // reset- and presence-errors
+    ERROR_COMMAND              = 10 // unknown command, incorrect slave usage
+};
+
+// slot-types for the timing-profiler (PROFILE_ENABLE), the margin is measured in loops
+enum class SlotType : uint8_t {
+    PRESENCE                   = 0, // loops left before the bus had to be released (PRESENCE_LOW_ON_LINE)
+    WRITE_ZERO                 = 1, // loops the hub waited for the falling edge before it had to pull the bus low
+    WRITE_ONE                  = 2, // same as above, but the bus stays passive
+    READ_SAMPLE                = 3, // loops the hub waited for the falling edge before it had to sample the bus
+    SEARCH_TRIPLET             = 4  // all three slots of each searchIDTree()-step
+};
+
+constexpr uint8_t SLOT_TYPE_COUNT   {5};
+constexpr uint8_t PROFILE_BUCKETS   {12}; // bucket n holds margins with n significant bits, the last one is open ended
+
+struct SlotProfile
+{
+    timeOW_t margin_min;                // lowest margin seen so far
+    uint32_t count;                     // number of measured slots
+    uint16_t bucket[PROFILE_BUCKETS];   // histogram, gets halved before a bucket saturates
+};
+
+// record of the deferred log (LOG_ENABLE), gets formatted later by drainLog()
+struct LogRecord
+{
+    uint32_t timestamp;     // micros() at push
+    Error    error;
+    uint8_t  cmd;           // offending command, 0 if not relevant
+    uint8_t  bit;           // bit-position inside the byte, 255 if unknown
+    uint8_t  source;        // family code of the selected slave, 0 for the hub itself
+};
+
+// hot paths measured by the cycle-probes (PROBE_ENABLE), see cycleCount() in platform.h
+enum class Probe : uint8_t {
+    SEND_BIT                   = 0, // includes waiting for the master, so min is the interesting value
+    RECV_BIT                   = 1, // same as above
+    SEARCH_ID_TREE             = 2,
+    CRC                        = 3, // crc8() and both crc16() of OneWireItem
+    DUTY                       = 4  // every duty()-call of the selected slave
+};
+
+constexpr uint8_t PROBE_COUNT       {5};
+
+struct ProbeStats
+{
+    uint32_t calls;
+    uint64_t cycles_sum;
+    cycle_t  cycles_min;
+    cycle_t  cycles_max;
+};
+
+// default source for OneWireHub::sendPages(): plain memory without prefix, suffix or stored crc
+// devices derive from it and hide the functions they want to change (see DS2450, DS2506, DS2423)
+class PageSource
+{
+public:
+
+    const uint8_t * const memory;
+    const uint16_t        memory_size;  // pages beyond read as zero (fake data)
+
+    PageSource(const uint8_t memory_start[], const uint16_t size) : memory(memory_start), memory_size(size) {};
+
+    const uint8_t * getPage(const uint16_t page, const uint8_t page_size) const // nullptr for fake data
+    {
+        const uint16_t position = page * page_size;
+        return (position < memory_size) ? &memory[position] : nullptr;
+    };
+
+    bool    getPrefix(const uint16_t, uint8_t &) const { return false; }; // one byte before the page, followed by its own crc
+    uint8_t getSuffix(const uint16_t, uint8_t []) const { return 0; };    // bytes after the page-data (max 8), covered by the page-crc
+    bool    getCRC(const uint16_t, uint16_t &) const { return false; };   // crc16 of the whole page-data with init 0, if known
+    void    setCRC(const uint16_t, const uint16_t) { };                    // gets the crc16 of a whole page after calculating it
+};
+
+// command-table of a register-mapped slave: a constexpr array in flash (PROGMEM), searched by recvCommand()
+enum class CrcMode : uint8_t {
+    NONE                       = 0, // plain data
+    END                        = 1  // inverted crc16 (over command, address and data) after the data
+};
+
+struct RegisterCommand
+{
+    uint8_t  cmd;
+    uint8_t  address_bytes;         // target address following the command (little endian, 0 to 2 byte), part of the crc
+    uint16_t address_mask;          // applied before the range-check
+    uint16_t first;                 // lowest valid address, maps to memory[0] in sendRegisters()
+    uint16_t last;                  // highest valid address, a readout ends after it
+    CrcMode  crc;                   // of sendRegisters(), paged memory with a crc per page goes through sendPages() instead
+};
 
 class OneWireItem;
 
+// change of a slave made by the master (EVENT_ENABLE), posted in duty() and drained by the application with popEvent()
+struct DeviceEvent
+{
+    const OneWireItem * source; // slave that got changed, compare with the address of your slave-object
+    uint16_t address;           // first changed register / memory-address, device specific
+    uint8_t  length;            // number of changed bytes
+    uint8_t  value;             // new content of the first changed byte
+};
+
+// committed write of the master (JOURNAL_ENABLE), appended in duty() and drained by the application with popJournal()
+// binary layout (packJournal()): slave, command, sequence (2 byte), address (2 byte), length, data - little endian
+struct JournalRecord
+{
+    uint8_t  slave;                 // index of the slave in the hub, a standby has to attach the same slaves in the same order
+    uint8_t  command;               // 1-wire-command that committed the write, device specific
+    uint16_t sequence;              // counts every record of the hub, a gap means the ring was full and records got lost
+    uint16_t address;               // first written address, device specific
+    uint8_t  length;                // number of written bytes
+    uint8_t  data[HUB_ARENA_SIZE];  // the biggest scratchpad, longer writes get split
+};
+
+// single producer (duty()) / single consumer (loop()) ring for the log and the events, SIZE must be a power of two (max 128)
+// the producer fills the slot of reserve() and publishes it with commit(), a full ring drops the new entry - the oldest ones are more valuable
+template <typename T, uint8_t SIZE>
+class Ring
+{
+private:
+
+    T                 entry[SIZE];
+    volatile uint8_t  head;     // only written by the producer
+    volatile uint8_t  tail;     // only written by the consumer
+    volatile uint16_t dropped;  // only written by the producer
+
+public:
+
+    Ring(void) : head(0), tail(0), dropped(0)
+    {
+        static_assert((SIZE & (SIZE - 1)) == 0, "Size of the ring must be a power of two");
+        static_assert(SIZE <= 128, "Size of the ring is too big");
+    };
+
+    T * reserve(void) // nullptr if the ring is full
+    {
+        if (((head + uint8_t(1)) & (SIZE - 1)) == tail)
+        {
+            if (dropped < 0xFFFF) dropped++;
+            return nullptr;
+        };
+        return &entry[head];
+    };
+
+    void commit(void) { head = (head + uint8_t(1)) & (SIZE - 1); }; // only after the entry is complete
+
+    bool pop(T &destination)
+    {
+        const uint8_t position = tail;
+        if (position == head) return false;
+        destination = entry[position];
+        tail        = (position + uint8_t(1)) & (SIZE - 1);
+        return true;
+    };
+
+    uint16_t getDropped(void) const { return dropped; };
+};
+
 class OneWireHub
 {
 private:
 
+    friend class CycleProbe;
+
     static constexpr uint8_t ONEWIRESLAVE_LIMIT                 = HUB_SLAVE_LIMIT;
     static constexpr uint8_t ONEWIRE_TREE_SIZE                  = ( 2 * ONEWIRESLAVE_LIMIT ) - 1;
 
@@ -79,13 +265,52 @@ private:
 
     Error   _error;
     uint8_t _error_cmd;
+    uint8_t _error_bit; // bit-position inside the byte where send() / recv() failed
+
+#if PROFILE_ENABLE
+    SlotProfile profile[SLOT_TYPE_COUNT];
+    bool        profile_search; // redirects the bit-slots of searchIDTree() into their own profile
+#endif
+
+#if STATS_ENABLE
+    HubStats stats;
+#endif
+
+#if LOG_ENABLE
+    Ring<LogRecord, LOG_SIZE> log_ring;
+    uint16_t          log_dropped_reported; // only written by drainLog()
+#endif
+
+#if EVENT_ENABLE
+    Ring<DeviceEvent, EVENT_SIZE> event_ring;
+#endif
+
+#if JOURNAL_ENABLE
+    uint8_t           journal_ring[JOURNAL_SIZE];
+    volatile uint16_t journal_head;         // only written by pushJournal()
+    volatile uint16_t journal_tail;         // only written by popJournal()
+    uint16_t          journal_sequence;     // only written by pushJournal()
+    volatile uint16_t journal_dropped;      // only written by pushJournal()
+#endif
+
+#if PROBE_ENABLE
+    static ProbeStats probe_stats[PROBE_COUNT]; // shared by all hubs, the CRC-FNs of the slaves know no hub
+#endif
+
+    static uint8_t             arena[HUB_ARENA_SIZE]; // shared by all hubs, only one slave is selected at a time
+    static const OneWireItem * arena_owner;
 
     io_reg_t          pin_bitMask;
     volatile io_reg_t *pin_baseReg;
 
-#if 1 //USE_GPIO_DEBUG
-    io_reg_t          debug_bitMask;
-    volatile io_reg_t *debug_baseReg;
+#if USE_GPIO_DEBUG
+    io_reg_t          debug_bitMask[GPIO_DEBUG_PIN_COUNT];
+    volatile io_reg_t *debug_baseReg[GPIO_DEBUG_PIN_COUNT];
+#if defined(DIRECT_WRITE_MASKED)
+    io_reg_t          debug_portMask;   // all debug-pins that share the port of the first one
+    io_reg_t          debug_code[16];   // port-value for every state-code
+#endif
+    uint8_t           debug_state;
 #endif
 
     uint8_t      slave_count;
@@ -99,9 +324,11 @@ private:
         uint8_t got_one;         // if 1 switch to which tree branch
     } idTree[ONEWIRE_TREE_SIZE];
 
+    uint8_t insertSlave(OneWireItem &sensor, bool &inserted); // returns the position, 255 if the hub is full
     uint8_t buildIDTree(void);
     uint8_t buildIDTree(uint8_t position_IDBit, const mask_t slave_mask);
     void    searchIDTree(void);
+    void    searchAlarm(void);
 
     uint8_t getNrOfFirstBitSet(const mask_t mask) const;
     uint8_t getNrOfFirstFreeIDTreeElement(void) const;
@@ -116,17 +343,39 @@ private:
     inline __attribute__((always_inline))
     timeOW_t waitLoopsWhilePinIs(volatile timeOW_t retries, const bool pin_value = false) const;
 
+    void beginStream(void);                                                          // interrupts off, bus released
+    void endStream(void);
+    bool sendStream(const uint8_t address[], const uint8_t data_length);             // inner loop of send(), expects beginStream()
+    bool sendStream(const uint8_t address[], const uint8_t data_length, uint16_t &crc16);
+    bool sendStreamZeros(const uint8_t data_length, uint16_t &crc16);                // fake data
+    bool loadCommand(const RegisterCommand table[], const uint8_t table_size, const uint8_t cmd, RegisterCommand &command); // entry of recvCommand(), false for unknown commands
+
+    static uint8_t getBitPosition(const uint8_t bitMask);
+    static DebugState getDebugState(const Error error); // error-class for the GPIO-debug-port
+    static void    printErrorText(const Error error, const uint8_t cmd);
+
+    inline __attribute__((always_inline))
+    void     setDebugState(const DebugState state);
+
+    inline __attribute__((always_inline))
+    void     pulseDebugState(void); // marks a finished byte
+
+    inline __attribute__((always_inline))
+    void     profileSlot(const SlotType slot_type, const timeOW_t margin);
+
 public:
 
     explicit OneWireHub(const uint8_t pin);
 
     uint8_t attach(OneWireItem &sensor);
+    uint8_t attach(OneWireItem * const sensors[], const uint8_t count); // builds the search-tree once, returns the number of attached sensors
     bool    detach(const OneWireItem &sensor);
     bool    detach(const uint8_t slave_number);
 
     uint8_t getIndexOfNextSensorInList(const uint8_t index_start = 0) const;
+    const OneWireItem * getSlave(const uint8_t slave_number) const; // returns nullptr for empty positions
 
-    bool poll(void);
+    bool poll(void); // memory-devices with a page-crc-cache (ds2423, ds2450, ds2502, ds2506) want their updateCRC() next to it, after writes of the master
 
     bool sendBit(const bool value);                                                 // returns 1 if error occured
     bool send(const uint8_t dataByte);                                              // returns 1 if error occured
@@ -135,6 +384,11 @@ public:
     // CRC takes ~7.4µs/byte (Atmega328P@16MHz) but is distributing the load between each bit-send to 0.9 µs/bit (see debug-crc-comparison.ino)
     // important: the final crc is expected to be inverted (crc=~crc) !!!
 
+    // streams pages from position till end, each page is followed by its inverted crc16, interrupts stay off for the whole readout
+    // crc16 seeds the first page (cmd and TA), every following page starts at zero (same for the page after a prefix)
+    template <typename source_t>
+    bool sendPages(source_t &source, uint16_t position, const uint16_t end, const uint8_t page_size, uint16_t &crc16); // returns 1 if error occured
+
     bool    recvBit(void);
     bool    recv(uint8_t address[], const uint8_t data_length = 1);                 // returns 1 if error occured
     bool    recv(uint8_t address[], const uint8_t data_length, uint16_t &crc16);    // returns 1 if error occured
@@ -150,6 +404,142 @@ public:
     void  raiseSlaveError(const uint8_t cmd = 0);
     Error clearError(void);
 
+    // deferred log, only active with LOG_ENABLE in config, errors of poll() get pushed automatically (except FIRST_TIMESLOT_TIMEOUT, it is OK)
+    void     pushLog(const Error error, const uint8_t cmd = 0, const uint8_t bit = 255); // no formatting, usable in duty()
+    bool     popLog(LogRecord &record);          // returns false if empty, for own handling of the binary records
+    uint8_t  drainLog(void);                     // formats and prints via serial, returns number of records, call it in loop()
+    uint16_t getLogDropped(void) const;          // records lost because the ring was full
+
+    // change-events, only active with EVENT_ENABLE in config, single producer (duty()) and single consumer (loop())
+    void     pushEvent(const OneWireItem &source, const uint16_t address, const uint8_t length, const uint8_t value); // usable in duty()
+    bool     popEvent(DeviceEvent &event);       // returns false if empty, call it in loop()
+    uint16_t getEventDropped(void) const;        // events lost because the ring was full
+
+    // write-journal, only active with JOURNAL_ENABLE in config, single producer (duty()) and single consumer (loop())
+    void     pushJournal(const OneWireItem &source, const uint8_t command, const uint16_t address, const uint8_t data[], const uint8_t length); // usable in duty()
+    bool     popJournal(JournalRecord &record);            // returns false if empty, call it in loop()
+    uint16_t getJournalDropped(void) const;                // records lost because the ring was full
+    bool     replayJournal(const JournalRecord &record);   // applies a record of another hub to the slave with the same index, returns false if it is missing or rejects the record
+    static uint8_t packJournal(const JournalRecord &record, uint8_t buffer[]);                        // binary record for the transport, buffer needs 7 + HUB_ARENA_SIZE bytes, returns the used length
+    static uint8_t unpackJournal(const uint8_t buffer[], const uint8_t size, JournalRecord &record); // returns the consumed length, 0 if the buffer holds no complete record
+
+    // snapshot of the whole hub, only active with SNAPSHOT_ENABLE in config, call it outside of bus-activity
+    // layout: "OWHS", version, slave-limit, slave-count, tree-size, search-tree, per slave: position, id, state-size (2 byte), state - crc16 at the end
+    uint32_t getSnapshotSize(void) const;
+    uint32_t saveSnapshot(uint8_t buffer[], const uint32_t size) const; // returns the used bytes, 0 if the buffer is too small
+    bool     loadSnapshot(const uint8_t buffer[], const uint32_t size);  // same slaves (ids) at the same positions as the saved hub, nothing changes if a check fails
+
+    // table-driven duty(): receives command and target address, unknown commands raise the slave-error, returns 1 if the transaction is over (also when out of range)
+    bool    recvCommand(const RegisterCommand table[], const uint8_t table_size, RegisterCommand &command, uint16_t &address, uint16_t &crc16);
+    bool    recvCommand(const RegisterCommand table[], const uint8_t table_size, RegisterCommand &command, uint16_t &address); // without crc, for slaves that never send one
+    bool    sendRegisters(const RegisterCommand &command, const uint8_t memory[], const uint16_t address, uint16_t &crc16); // readout from address to last
+
+    // transaction-arena: scratch-buffer for the duty() of the selected slave, content survives till another slave claims it
+    static uint8_t * claimArena(const OneWireItem &owner);    // HUB_ARENA_SIZE bytes, content is undefined if the owner changed
+    static bool      ownsArena(const OneWireItem &owner);     // false if another slave claimed the arena since
+
+    // timing-profiler, only active with PROFILE_ENABLE in config, all margins in loops (timeUsToLoops())
+    void     clearProfile(void);
+    uint32_t getProfileCount(const SlotType slot_type) const;
+    timeOW_t getProfileMinimum(const SlotType slot_type) const;
+    timeOW_t getProfilePercentile(const SlotType slot_type, const uint8_t percent) const; // lower bound of the bucket
+    void     printProfile(void) const;
+
+    // bus-statistics, only active with STATS_ENABLE in config
+    void     clearStats(void);
+    bool     getStats(HubStats &destination) const; // copies the counters, returns false (and zeros) if disabled
+
+    // cycle-probes, only active with PROBE_ENABLE in config, all values in cpu-cycles (cycleCount()) and shared by all hubs
+    static void     clearProbes(void);
+    static uint32_t getProbeCalls(const Probe probe);
+    static cycle_t  getProbeMinimum(const Probe probe);
+    static cycle_t  getProbeMaximum(const Probe probe);
+    static cycle_t  getProbeMean(const Probe probe);
+    static void     printProbes(void);
+
+};
+
+#if PROBE_ENABLE
+// measures the cycles between construction and destruction, use HUB_PROBE() at the beginning of a scope
+class CycleProbe
+{
+private:
+
+    ProbeStats    &stats;
+    const cycle_t cycles_start;
+
+public:
+
+    explicit CycleProbe(const Probe probe) : stats(OneWireHub::probe_stats[static_cast<uint8_t>(probe)]), cycles_start(cycleCount()) {};
+
+    ~CycleProbe()
+    {
+        const cycle_t cycles = cycleCount() - cycles_start; // wraps around correctly
+        stats.calls++;
+        stats.cycles_sum += cycles;
+        if (cycles < stats.cycles_min) stats.cycles_min = cycles;
+        if (cycles > stats.cycles_max) stats.cycles_max = cycles;
+    };
+
+    CycleProbe(const CycleProbe&) = delete;
+    CycleProbe& operator=(const CycleProbe&) = delete;
+};
+
+#define HUB_PROBE(probe) const CycleProbe cycle_probe(probe)
+#else
+#define HUB_PROBE(probe)
+#endif
+
+// one page per round: [prefix, ~crc16] data [suffix] ~crc16, the master ends the readout with a reset
+template <typename source_t>
+bool OneWireHub::sendPages(source_t &source, uint16_t position, const uint16_t end, const uint8_t page_size, uint16_t &crc16)
+{
+    bool error = false;
+    beginStream();
+
+    while (position < end)
+    {
+        const uint16_t page   = position / page_size;
+        const uint8_t  offset = uint8_t(position) & (page_size - uint8_t(1));
+        const uint8_t  length = page_size - offset;
+
+        uint8_t buffer[8];
+        if (source.getPrefix(page, buffer[0]))
+        {
+            if ((error = sendStream(buffer, 1, crc16))) break;
+            crc16 = ~crc16; // normally crc16 is sent ~inverted
+            if ((error = sendStream(reinterpret_cast<uint8_t *>(&crc16), 2))) break;
+            crc16 = 0;
+        };
+
+        const uint8_t * const data  = source.getPage(page, page_size);
+        const bool            whole = (crc16 == 0) && (offset == 0) && (data != nullptr); // crc only covers this page
+
+        if (data == nullptr)
+        {
+            if ((error = sendStreamZeros(length, crc16))) break;
+        }
+        else if (whole && source.getCRC(page, crc16))
+        {
+            if ((error = sendStream(data, length))) break;
+        }
+        else
+        {
+            if ((error = sendStream(&data[offset], length, crc16))) break;
+            if (whole) source.setCRC(page, crc16);
+        };
+
+        const uint8_t suffix_length = source.getSuffix(page, buffer);
+        if (suffix_length && (error = sendStream(buffer, suffix_length, crc16))) break;
+
+        crc16 = ~crc16; // normally crc16 is sent ~inverted
+        if ((error = sendStream(reinterpret_cast<uint8_t *>(&crc16), 2))) break;
+        crc16 = 0;
+        position += length;
+    };
+
+    endStream();
+    return error;
 };
 
 #endif
@@ -8,10 +8,45 @@
 // INFO: had to go with a define because some compilers use constexpr as simple const --> massive problems
 #define HUB_SLAVE_LIMIT     8 // set the limit of the hub HERE, max is 32 devices
 #define OVERDRIVE_ENABLE    0 // support overdrive for the slaves
+#define PROFILE_ENABLE      0 // measure the timing-margin of every slot (see printProfile()), costs ~170 byte RAM and some loops per bit
+#define PROBE_ENABLE        0 // count the cpu-cycles of hot paths like sendBit(), crc and duty() (see printProbes()), the probes itself cost cycles and bus-timing
+#define STATS_ENABLE        0 // count resets, rom-commands and errors per type (see getStats()), the HubDiag-slave exposes them to the master
+#define LOG_ENABLE          0 // push errors as binary records into a ring, drainLog() prints them later outside of bus-activity
+#define LOG_SIZE            8 // records in the log-ring, must be a power of two (max 128), every record takes 8 byte RAM
+#define EVENT_ENABLE        0 // slaves post changes made by the master into a ring, the application drains it with popEvent() instead of polling every getter
+#define EVENT_SIZE          8 // events in the event-ring, must be a power of two (max 128), every event takes 6 byte RAM on avr, 8 on 32 bit mcus and 16 on 64 bit hosts
+#define JOURNAL_ENABLE      0 // slaves append every committed write of the master (address and bytes) to a ring, popJournal() drains it for replication or audit, replayJournal() applies it to a standby
+#define JOURNAL_SIZE        256 // bytes of the journal-ring, must be a power of two (max 32768), a record takes 7 byte + the written bytes
+#define USE_GPIO_DEBUG      0 // state-codes on a debug-port for a logic analyzer (see readme.md for info), is a better alternative to serial debug
+#define PROVIDER_ENABLE     0 // ds18b20, ds2438 and ds2450 ask a SampleProvider for a fresh value when the master starts a conversion, so sensors get sampled on demand instead of by setters all the time
+#define DOUBLE_BUFFER_ENABLE 0 // keep shadow-copies of the device-state that setters can change while the bus reads (see DoubleBuffer), costs two extra copies, needed if setters and poll() run in different contexts (interrupts)
+#define PAGE_POOL_ENABLE    0 // ds2503, ds2505 and ds2506 offer their full memory, only written pages take RAM from a pool of PAGE_POOL_SIZE pages (see PagePool)
+#define FLASH_IMAGE_ENABLE  0 // ds2431, ds2433 and ds2502 read a constant image from flash (setImage()), only pages written by the master take RAM from an overlay of IMAGE_OVERLAY_SIZE pages
+#define PERSIST_ENABLE      0 // memory, counters, status and eeprom of the devices survive a reboot, PersistLog writes them to a PersistStore (eeprom, file) from loop()
+#define SNAPSHOT_ENABLE     0 // saveSnapshot() / loadSnapshot() copy the whole state of a hub (ids, search-tree, device-state) into a versioned binary buffer, for warm starts and forks of a simulated bus
+#define STATE_ENABLE        (PERSIST_ENABLE || SNAPSHOT_ENABLE) // state-hooks of the devices (getStateSize(), readState(), writeState()), needed by both
+#define CRC_KERNEL          0 // 0: auto (avr-libc on AVR, nibble-table elsewhere), 1: bitwise, 2: nibble-table, 3: 256-entry-table in flash, 4: slice-by-4 (host only)
+
+// the target feature_check (CMakeLists.txt) defines ONEWIREHUB_FEATURE_CHECK, feature_check.cpp tests these optional features on the host
+#if defined(ONEWIREHUB_FEATURE_CHECK)
+#undef  PAGE_POOL_ENABLE
+#define PAGE_POOL_ENABLE    1
+#undef  PERSIST_ENABLE
+#define PERSIST_ENABLE      1
+#undef  SNAPSHOT_ENABLE
+#define SNAPSHOT_ENABLE     1
+#undef  JOURNAL_ENABLE
+#define JOURNAL_ENABLE      1
+#endif
 
 constexpr bool     USE_SERIAL_DEBUG { 0 }; // give debug messages when printError() is called (be aware! it may produce heisenbugs, timing is critical)
-constexpr bool     USE_GPIO_DEBUG   { 1 }; // is a better alternative to serial debug (see readme.md for info)
-constexpr uint8_t  GPIO_DEBUG_PIN   { 7 }; // digital pin
+constexpr uint8_t  GPIO_DEBUG_PIN   { 7 }; // digital pin, carries bit 0 of the state-code
+constexpr uint8_t  GPIO_DEBUG_PIN_COUNT { 1 };                        // 1 to 4 pins, one masked write per state-change if they share a port
+constexpr uint8_t  GPIO_DEBUG_PINS[4] { GPIO_DEBUG_PIN, 6, 5, 4 };    // carry bit 0 to 3 of the state-code, atmega328: all on PORTD
+constexpr uint8_t  HUB_ARENA_SIZE   { 32 }; // transaction-arena shared by all slaves (see claimArena()), must fit the biggest scratchpad (DS2423, DS2433, BAE910)
+constexpr uint8_t  PAGE_POOL_SIZE   { 8 }; // pages of 32 byte in the pool, a full pool reports all erased pages as write-protected
+constexpr uint8_t  IMAGE_OVERLAY_SIZE { 2 }; // pages of 32 byte that may differ from the flash-image, further writes get lost
+constexpr uint16_t PERSIST_BLOCKS   { 32 }; // blocks of 8 byte device-state a PersistLog can keep, costs 2 byte RAM each, max 65534 (a ds2433 needs 64, a DS2506Backed 1068)
 constexpr uint32_t REPETITIONS      { 5000 }; // for measuring the loop-delay --> 10000L takes ~110ms on atmega328p@16Mhz
 
 /// the following TIME-values are in microseconds and are taken mostly from the ds2408 datasheet
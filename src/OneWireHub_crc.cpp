@@ -0,0 +1,238 @@
+#include "OneWireHub_crc.h"
+
+//The CRC code was excerpted and inspired by the Dallas Semiconductor
+//sample code bearing this copyright.
+//---------------------------------------------------------------------------
+// Copyright (C) 2000 Dallas Semiconductor Corporation, All Rights Reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY,  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL DALLAS SEMICONDUCTOR BE LIABLE FOR ANY CLAIM, DAMAGES
+// OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// Except as contained in this notice, the name of Dallas Semiconductor
+// shall not be used except as stated in the Dallas Semiconductor
+// Branding Policy.
+//--------------------------------------------------------------------------
+
+// The 1-Wire CRC scheme is described in Maxim Application Note 27:
+// "Understanding and Using Cyclic Redundancy Checks with Maxim iButton Products"
+// the tables are taken from: https://github.com/PaulStoffregen/OneWire/blob/master/OneWire.cpp --> calc with table (EOF)
+// alternative for AVR: http://www.atmel.com/webdoc/AVRLibcReferenceManual/group__util__crc_1ga37b2f691ebbd917e36e40b096f78d996.html
+
+static const uint8_t crc8_nibble[16] PROGMEM =
+{
+        0x00, 0x9D, 0x23, 0xBE, 0x46, 0xDB, 0x65, 0xF8, 0x8C, 0x11, 0xAF, 0x32, 0xCA, 0x57, 0xE9, 0x74
+};
+
+static const uint16_t crc16_nibble[16] PROGMEM =
+{
+        0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+        0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400
+};
+
+static const uint8_t crc8_table[256] PROGMEM =
+{
+        0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83, 0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41,
+        0x9D, 0xC3, 0x21, 0x7F, 0xFC, 0xA2, 0x40, 0x1E, 0x5F, 0x01, 0xE3, 0xBD, 0x3E, 0x60, 0x82, 0xDC,
+        0x23, 0x7D, 0x9F, 0xC1, 0x42, 0x1C, 0xFE, 0xA0, 0xE1, 0xBF, 0x5D, 0x03, 0x80, 0xDE, 0x3C, 0x62,
+        0xBE, 0xE0, 0x02, 0x5C, 0xDF, 0x81, 0x63, 0x3D, 0x7C, 0x22, 0xC0, 0x9E, 0x1D, 0x43, 0xA1, 0xFF,
+        0x46, 0x18, 0xFA, 0xA4, 0x27, 0x79, 0x9B, 0xC5, 0x84, 0xDA, 0x38, 0x66, 0xE5, 0xBB, 0x59, 0x07,
+        0xDB, 0x85, 0x67, 0x39, 0xBA, 0xE4, 0x06, 0x58, 0x19, 0x47, 0xA5, 0xFB, 0x78, 0x26, 0xC4, 0x9A,
+        0x65, 0x3B, 0xD9, 0x87, 0x04, 0x5A, 0xB8, 0xE6, 0xA7, 0xF9, 0x1B, 0x45, 0xC6, 0x98, 0x7A, 0x24,
+        0xF8, 0xA6, 0x44, 0x1A, 0x99, 0xC7, 0x25, 0x7B, 0x3A, 0x64, 0x86, 0xD8, 0x5B, 0x05, 0xE7, 0xB9,
+        0x8C, 0xD2, 0x30, 0x6E, 0xED, 0xB3, 0x51, 0x0F, 0x4E, 0x10, 0xF2, 0xAC, 0x2F, 0x71, 0x93, 0xCD,
+        0x11, 0x4F, 0xAD, 0xF3, 0x70, 0x2E, 0xCC, 0x92, 0xD3, 0x8D, 0x6F, 0x31, 0xB2, 0xEC, 0x0E, 0x50,
+        0xAF, 0xF1, 0x13, 0x4D, 0xCE, 0x90, 0x72, 0x2C, 0x6D, 0x33, 0xD1, 0x8F, 0x0C, 0x52, 0xB0, 0xEE,
+        0x32, 0x6C, 0x8E, 0xD0, 0x53, 0x0D, 0xEF, 0xB1, 0xF0, 0xAE, 0x4C, 0x12, 0x91, 0xCF, 0x2D, 0x73,
+        0xCA, 0x94, 0x76, 0x28, 0xAB, 0xF5, 0x17, 0x49, 0x08, 0x56, 0xB4, 0xEA, 0x69, 0x37, 0xD5, 0x8B,
+        0x57, 0x09, 0xEB, 0xB5, 0x36, 0x68, 0x8A, 0xD4, 0x95, 0xCB, 0x29, 0x77, 0xF4, 0xAA, 0x48, 0x16,
+        0xE9, 0xB7, 0x55, 0x0B, 0x88, 0xD6, 0x34, 0x6A, 0x2B, 0x75, 0x97, 0xC9, 0x4A, 0x14, 0xF6, 0xA8,
+        0x74, 0x2A, 0xC8, 0x96, 0x15, 0x4B, 0xA9, 0xF7, 0xB6, 0xE8, 0x0A, 0x54, 0xD7, 0x89, 0x6B, 0x35
+};
+
+static const uint16_t crc16_table[256] PROGMEM =
+{
+        0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+        0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+        0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+        0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+        0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+        0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+        0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+        0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+        0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+        0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+        0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+        0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+        0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+        0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+        0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+        0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+        0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+        0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+        0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+        0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+        0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+        0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+        0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+        0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+        0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+        0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+        0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+        0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+        0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+        0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+        0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+        0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
+};
+
+/////////////////////////////////////////// CRC8 ///////////////////////////////////////////////
+
+// the slow but memory saving version, the calculation is not time-critical and happens offline
+uint8_t crc8Bitwise(const uint8_t address[], const uint8_t length, uint8_t crc)
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        uint8_t inByte = address[i];
+        for (uint8_t j = 8; j; --j)
+        {
+            uint8_t mix = (crc ^ inByte) & static_cast<uint8_t>(0x01);
+            crc >>= 1;
+            if (mix) crc ^= 0x8C;
+            inByte >>= 1;
+        }
+    }
+    return crc;
+};
+
+uint8_t crc8Nibble(const uint8_t address[], const uint8_t length, uint8_t crc)
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        crc ^= address[i];
+        crc = (crc >> 4) ^ pgm_read_byte(&crc8_nibble[crc & 0x0F]);
+        crc = (crc >> 4) ^ pgm_read_byte(&crc8_nibble[crc & 0x0F]);
+    }
+    return crc;
+};
+
+uint8_t crc8Table(const uint8_t address[], const uint8_t length, uint8_t crc)
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        crc = pgm_read_byte(&crc8_table[crc ^ address[i]]);
+    }
+    return crc;
+};
+
+/////////////////////////////////////////// CRC16 //////////////////////////////////////////////
+
+uint16_t crc16Bitwise(const uint8_t address[], const uint8_t length, uint16_t crc)
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        uint8_t inByte = address[i];
+        for (uint8_t j = 8; j; --j)
+        {
+            const uint8_t mix = (static_cast<uint8_t>(crc) ^ inByte) & static_cast<uint8_t>(0x01);
+            crc >>= 1;
+            if (mix) crc ^= static_cast<uint16_t>(0xA001);
+            inByte >>= 1;
+        }
+    }
+    return crc;
+};
+
+uint16_t crc16Nibble(const uint8_t address[], const uint8_t length, uint16_t crc)
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        crc ^= address[i];
+        crc = (crc >> 4) ^ pgm_read_word(&crc16_nibble[crc & 0x0F]);
+        crc = (crc >> 4) ^ pgm_read_word(&crc16_nibble[crc & 0x0F]);
+    }
+    return crc;
+};
+
+uint16_t crc16Table(const uint8_t address[], const uint8_t length, uint16_t crc)
+{
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        crc = (crc >> 8) ^ pgm_read_word(&crc16_table[static_cast<uint8_t>(crc) ^ address[i]]);
+    }
+    return crc;
+};
+
+/////////////////////////////////////////// SLICE BY 4 /////////////////////////////////////////
+
+#if !defined(ARDUINO)
+// tables get derived from the 256-entry-tables on first use, table[0] is the normal one
+static uint8_t  crc8_slice[4][256];
+static uint16_t crc16_slice[4][256];
+
+static void initSlice4(void)
+{
+    static bool initialized = false;
+    if (initialized) return;
+
+    for (uint16_t i = 0; i < 256; ++i)
+    {
+        crc8_slice[0][i]  = crc8_table[i];
+        crc16_slice[0][i] = crc16_table[i];
+    }
+    for (uint8_t k = 1; k < 4; ++k)
+    {
+        for (uint16_t i = 0; i < 256; ++i)
+        {
+            crc8_slice[k][i]  = crc8_table[crc8_slice[k-1][i]];
+            crc16_slice[k][i] = (crc16_slice[k-1][i] >> 8) ^ crc16_table[crc16_slice[k-1][i] & 0xFF];
+        }
+    }
+    initialized = true;
+};
+
+uint8_t crc8Slice4(const uint8_t address[], const uint8_t length, uint8_t crc)
+{
+    initSlice4();
+    uint8_t i = 0;
+    for ( ; (i + 4) <= length; i += 4)
+    {
+        crc = crc8_slice[3][crc ^ address[i]] ^ crc8_slice[2][address[i+1]] ^ crc8_slice[1][address[i+2]] ^ crc8_slice[0][address[i+3]];
+    }
+    for ( ; i < length; ++i)
+    {
+        crc = crc8_slice[0][crc ^ address[i]];
+    }
+    return crc;
+};
+
+uint16_t crc16Slice4(const uint8_t address[], const uint8_t length, uint16_t crc)
+{
+    initSlice4();
+    uint8_t i = 0;
+    for ( ; (i + 4) <= length; i += 4)
+    {
+        const uint16_t mix = crc ^ (address[i] | (static_cast<uint16_t>(address[i+1]) << 8));
+        crc = crc16_slice[3][mix & 0xFF] ^ crc16_slice[2][mix >> 8] ^ crc16_slice[1][address[i+2]] ^ crc16_slice[0][address[i+3]];
+    }
+    for ( ; i < length; ++i)
+    {
+        crc = (crc >> 8) ^ crc16_slice[0][static_cast<uint8_t>(crc) ^ address[i]];
+    }
+    return crc;
+};
+#endif
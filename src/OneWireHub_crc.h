@@ -0,0 +1,34 @@
+// CRC-kernels behind OneWireItem::crc8() and crc16(), select one with CRC_KERNEL in config
+// all kernels compute the same CRC, they only trade flash / RAM for speed (see crc_benchmark.cpp for the host)
+
+#ifndef ONEWIREHUB_CRC_H
+#define ONEWIREHUB_CRC_H
+
+#include "OneWireHub.h"
+
+#define CRC_KERNEL_AUTO     0 // avr-libc on AVR, nibble-table elsewhere
+#define CRC_KERNEL_BITWISE  1 // no table, slowest
+#define CRC_KERNEL_NIBBLE   2 // 16 entries per CRC (48 byte flash)
+#define CRC_KERNEL_TABLE    3 // 256 entries per CRC (768 byte flash)
+#define CRC_KERNEL_SLICE4   4 // 4 bytes per step with 4x256 entries per CRC (3 kByte RAM), host only
+
+// CRC8 of type 0x8C (reflected 0x31), used for the ROM
+uint8_t  crc8Bitwise(const uint8_t address[], const uint8_t length, uint8_t crc);
+uint8_t  crc8Nibble(const uint8_t address[], const uint8_t length, uint8_t crc);
+uint8_t  crc8Table(const uint8_t address[], const uint8_t length, uint8_t crc);
+
+// CRC16 of type 0xA001 for little endian, the final crc is expected to be inverted (crc=~crc) !!!
+uint16_t crc16Bitwise(const uint8_t address[], const uint8_t length, uint16_t crc);
+uint16_t crc16Nibble(const uint8_t address[], const uint8_t length, uint16_t crc);
+uint16_t crc16Table(const uint8_t address[], const uint8_t length, uint16_t crc);
+
+#if !defined(ARDUINO)
+uint8_t  crc8Slice4(const uint8_t address[], const uint8_t length, uint8_t crc);
+uint16_t crc16Slice4(const uint8_t address[], const uint8_t length, uint16_t crc);
+#endif
+
+#if (CRC_KERNEL == CRC_KERNEL_SLICE4) && defined(ARDUINO)
+#error "CRC_KERNEL_SLICE4 is meant for the host, use CRC_KERNEL_TABLE on a µC"
+#endif
+
+#endif //ONEWIREHUB_CRC_H
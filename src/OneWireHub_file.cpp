@@ -0,0 +1,135 @@
+#include "OneWireHub_file.h"
+
+#if !defined(ARDUINO) && (defined(__unix__) || defined(__APPLE__))
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MappedFile::open(const char path[], const uint32_t length)
+{
+    close();
+    if (length == 0) return false;
+
+    descriptor = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (descriptor < 0) return false;
+
+    struct stat info;
+    if (fstat(descriptor, &info) != 0)
+    {
+        close();
+        return false;
+    };
+
+    const uint32_t existing = (uint32_t(info.st_size) < length) ? uint32_t(info.st_size) : length;
+    if ((existing < length) && (ftruncate(descriptor, length) != 0))
+    {
+        close();
+        return false;
+    };
+
+    void * const mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (mapping == MAP_FAILED)
+    {
+        close();
+        return false;
+    };
+
+    data = static_cast<uint8_t *>(mapping);
+    size = length;
+
+    if (existing < length) // a fresh eprom is erased
+    {
+        memset(&data[existing], static_cast<uint8_t>(0xFF), length - existing);
+        setDirty(existing, length - existing);
+    };
+    return true;
+};
+
+void MappedFile::close(void)
+{
+    if (data != nullptr)
+    {
+        sync();
+        munmap(data, size);
+        data = nullptr;
+        size = 0;
+    };
+    if (descriptor >= 0)
+    {
+        ::close(descriptor);
+        descriptor = -1;
+    };
+};
+
+bool MappedFile::sync(void)
+{
+    if (dirty_begin == dirty_end) return true;
+
+    const uint32_t page_size = static_cast<uint32_t>(sysconf(_SC_PAGESIZE));
+    const uint32_t begin     = dirty_begin & ~(page_size - 1); // msync needs an aligned address
+    const bool     success   = (msync(&data[begin], dirty_end - begin, MS_SYNC) == 0);
+
+    dirty_begin = dirty_end = 0;
+    return success;
+};
+
+void MappedFile::setDirty(const uint32_t position, const uint32_t length)
+{
+    if (length == 0) return;
+    if (dirty_begin == dirty_end)
+    {
+        dirty_begin = position;
+        dirty_end   = position + length;
+        return;
+    };
+    if (position < dirty_begin)             dirty_begin = position;
+    if ((position + length) > dirty_end)    dirty_end   = position + length;
+};
+
+
+bool FileBackend::readRange(const uint16_t position, uint8_t destination[], const uint16_t length)
+{
+    if ((position + length > size) || (offset + position + length > file.getSize())) return false;
+    memcpy(destination, &file.getData()[offset + position], length);
+    return true;
+};
+
+bool FileBackend::writeRange(const uint16_t position, const uint8_t source[], const uint16_t length)
+{
+    if ((position + length > size) || (offset + position + length > file.getSize())) return false;
+    memcpy(&file.getData()[offset + position], source, length);
+    file.setDirty(offset + position, length);
+    return true;
+};
+
+const uint8_t * FileBackend::getPage(const uint16_t page, const uint8_t page_size)
+{
+    const uint32_t position = uint32_t(page) * page_size;
+    if ((position + page_size > size) || (offset + position + page_size > file.getSize())) return nullptr; // a partial last page gets buffered
+    return &file.getData()[offset + position];
+};
+
+
+#if PERSIST_ENABLE
+uint16_t FileStore::getSize(void) const
+{
+    if (offset >= file.getSize()) return 0;
+    return ((file.getSize() - offset) < size) ? uint16_t(file.getSize() - offset) : size;
+};
+
+uint8_t FileStore::read(const uint16_t address) const
+{
+    return file.getData()[offset + address];
+};
+
+void FileStore::write(const uint16_t address, const uint8_t value)
+{
+    if (file.getData()[offset + address] == value) return;
+    file.getData()[offset + address] = value;
+    file.setDirty(offset + address, 1);
+};
+#endif
+
+#endif
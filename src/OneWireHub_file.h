@@ -0,0 +1,81 @@
+// files mapped into memory, only for the host-build (posix): dumps of real iButtons as content of the memory-devices
+// mapping is instant and copy-free, so hundreds of devices can be attached, the master writes straight into the mapped file
+// writes only extend the dirty range of the file, sync() flushes it in one batch - call it from the main loop, never from duty()
+
+#ifndef ONEWIREHUB_FILE_H
+#define ONEWIREHUB_FILE_H
+
+#include "OneWireItem.h"
+
+#if !defined(ARDUINO) && (defined(__unix__) || defined(__APPLE__))
+
+#include "OneWireHub_persist.h"
+
+class MappedFile
+{
+private:
+
+    uint8_t *   data;
+    uint32_t    size;
+    int         descriptor;
+    uint32_t    dirty_begin, dirty_end; // range written since the last sync(), empty if begin == end
+
+public:
+
+    MappedFile(void) : data(nullptr), size(0), descriptor(-1), dirty_begin(0), dirty_end(0) {};
+    ~MappedFile(void) { close(); };
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    bool     open(const char path[], const uint32_t length); // creates or grows the file to length, the new part reads erased (0xFF)
+    void     close(void);                                    // syncs and unmaps
+    bool     sync(void);                                     // writes the dirty range back to the file
+
+    uint8_t *getData(void) const { return data; };
+    uint32_t getSize(void) const { return size; };
+
+    void     setDirty(const uint32_t position, const uint32_t length);
+};
+
+// memory of a device at offset in a mapped file (setBackend() of DS2433Backed and the like), several devices can share one fixture-file
+class FileBackend : public MemoryBackend
+{
+private:
+
+    MappedFile &    file;
+    const uint32_t  offset;
+    const uint16_t  size;
+
+public:
+
+    FileBackend(MappedFile &mapped_file, const uint32_t position, const uint16_t length) : file(mapped_file), offset(position), size(length) {};
+
+    bool readRange(const uint16_t position, uint8_t destination[], const uint16_t length);
+    bool writeRange(const uint16_t position, const uint8_t source[], const uint16_t length);
+    const uint8_t * getPage(const uint16_t page, const uint8_t page_size); // points into the mapping, readouts need no copy
+};
+
+#if PERSIST_ENABLE
+// log of a PersistLog at offset in a mapped file, keeps counters, status and eeprom of the devices next to their memory-dumps
+class FileStore : public PersistStore
+{
+private:
+
+    MappedFile &    file;
+    const uint32_t  offset;
+    const uint16_t  size;
+
+public:
+
+    FileStore(MappedFile &mapped_file, const uint32_t position, const uint16_t length) : file(mapped_file), offset(position), size(length) {};
+
+    uint16_t getSize(void) const;
+    uint8_t  read(const uint16_t address) const;
+    void     write(const uint16_t address, const uint8_t value);
+};
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+#include "OneWireHub_persist.h"
+
+#if PERSIST_ENABLE
+
+PersistLog::PersistLog(PersistStore &persist_store) : store(persist_store), item_count(0), sequence(0), head(NO_SLOT), cursor(0)
+{
+    static_assert(PERSIST_BLOCKS < NO_KEY, "Too many blocks for the key of a record");
+    slot_count    = store.getSize() / RECORD_SIZE;
+    item_block[0] = 0;
+    for (uint16_t block = 0; block < PERSIST_BLOCKS; ++block) slot[block] = NO_SLOT;
+};
+
+bool PersistLog::readRecord(const uint16_t index, uint16_t &key, uint32_t &seq, uint8_t data[]) const
+{
+    uint8_t record[RECORD_SIZE];
+    const uint16_t address = index * RECORD_SIZE;
+    for (uint8_t i = 0; i < RECORD_SIZE; ++i) record[i] = store.read(address + i);
+
+    key = uint16_t(record[0]) | (uint16_t(record[1]) << 8);
+    if (key == NO_KEY) return false;
+    if (record[RECORD_SIZE - 1] != uint8_t(~OneWireItem::crc8(record, RECORD_SIZE - 1))) return false; // inverted, so a zeroed store holds no valid record
+
+    seq = uint32_t(record[2]) | (uint32_t(record[3]) << 8) | (uint32_t(record[4]) << 16) | (uint32_t(record[5]) << 24);
+    memcpy(data, &record[6], BLOCK_SIZE);
+    return true;
+};
+
+bool PersistLog::isLive(const uint16_t index) const
+{
+    uint16_t key;
+    uint8_t  data[BLOCK_SIZE];
+    uint32_t seq;
+    if (!readRecord(index, key, seq, data)) return false;
+    return (key < item_block[item_count]) && (slot[key] == index);
+};
+
+uint8_t PersistLog::locate(const uint16_t block, uint16_t &offset, uint8_t &length) const
+{
+    uint8_t position = 0;
+    while (block >= item_block[position + 1]) position++;
+    offset = (block - item_block[position]) * BLOCK_SIZE;
+    length = ((item_size[position] - offset) < BLOCK_SIZE) ? uint8_t(item_size[position] - offset) : BLOCK_SIZE;
+    return position;
+};
+
+void PersistLog::append(const uint16_t block, const uint8_t data[])
+{
+    uint16_t index;
+    do // attach() keeps half of the slots free, so this ends
+    {
+        index = head;
+        head  = ((head + 1) < slot_count) ? (head + 1) : 0;
+    } while (isLive(index));
+
+    uint8_t record[RECORD_SIZE];
+    record[0] = static_cast<uint8_t>(block);
+    record[1] = static_cast<uint8_t>(block >> 8);
+    for (uint8_t i = 0; i < 4; ++i) record[2 + i] = static_cast<uint8_t>(sequence >> (8*i));
+    memcpy(&record[6], data, BLOCK_SIZE);
+    record[RECORD_SIZE - 1] = ~OneWireItem::crc8(record, RECORD_SIZE - 1);
+
+    const uint16_t address = index * RECORD_SIZE;
+    for (uint8_t i = 0; i < RECORD_SIZE; ++i) store.write(address + i, record[i]);
+
+    slot[block] = index;
+    sequence++;
+};
+
+bool PersistLog::attach(OneWireItem &source, const uint16_t length)
+{
+    if (head != NO_SLOT)                return false; // attach before restore()
+    if (item_count >= HUB_SLAVE_LIMIT)  return false;
+
+    const uint16_t state_size = source.getStateSize();
+    const uint16_t size       = (length < state_size) ? length : state_size;
+    if (size == 0)                      return false;
+
+    const uint16_t blocks     = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    if (blocks > getBlocksFree())       return false; // PERSIST_BLOCKS or the store is too small
+
+    item[item_count]        = &source;
+    item_size[item_count]   = size;
+    item_block[item_count + 1] = item_block[item_count] + blocks;
+    item_count++;
+    return true;
+};
+
+uint16_t PersistLog::getBlocksFree(void) const
+{
+    const uint16_t capacity = ((slot_count / 2) < PERSIST_BLOCKS) ? (slot_count / 2) : PERSIST_BLOCKS; // half of the log stays free for wear-leveling
+    const uint16_t used     = item_block[item_count];
+    return (used < capacity) ? (capacity - used) : 0;
+};
+
+uint16_t PersistLog::restore(void)
+{
+    const uint16_t block_count = item_block[item_count];
+    uint16_t key;
+    uint8_t  data[BLOCK_SIZE];
+    uint32_t seq, newest = 0;
+    bool     found = false;
+
+    // one pass over the log: newest record of every block and the end of the log
+    head = 0;
+    for (uint16_t index = 0; index < slot_count; ++index)
+    {
+        if (!readRecord(index, key, seq, data)) continue;
+
+        if (!found || (seq > newest))
+        {
+            newest = seq;
+            head   = ((index + 1) < slot_count) ? (index + 1) : 0;
+            found  = true;
+        };
+
+        if (key >= block_count) continue;
+        if (slot[key] != NO_SLOT)
+        {
+            uint16_t key_live;
+            uint8_t  data_live[BLOCK_SIZE];
+            uint32_t seq_live;
+            if (readRecord(slot[key], key_live, seq_live, data_live) && (seq_live > seq)) continue;
+        };
+        slot[key] = index;
+    };
+    sequence = found ? (newest + 1) : 0;
+
+    uint16_t restored = 0;
+    for (uint16_t block = 0; block < block_count; ++block)
+    {
+        if ((slot[block] == NO_SLOT) || !readRecord(slot[block], key, seq, data)) continue;
+        uint16_t offset;
+        uint8_t  length;
+        const uint8_t position = locate(block, offset, length);
+        item[position]->writeState(offset, data, length);
+        restored++;
+    };
+    return restored;
+};
+
+uint16_t PersistLog::flush(const uint16_t blocks)
+{
+    const uint16_t block_count = item_block[item_count];
+    if ((head == NO_SLOT) || (block_count == 0)) return 0; // restore() has to come first, it finds the end of the log
+
+    uint16_t written = 0;
+    for (uint16_t count = 0; count < blocks; ++count)
+    {
+        const uint16_t block = cursor;
+        cursor = ((cursor + 1) < block_count) ? (cursor + 1) : 0;
+
+        uint8_t  length, data[BLOCK_SIZE], stored[BLOCK_SIZE];
+        uint16_t key, offset;
+        uint32_t seq;
+        const uint8_t position = locate(block, offset, length);
+        memset(data, static_cast<uint8_t>(0xFF), BLOCK_SIZE);
+        item[position]->readState(offset, data, length);
+        if ((slot[block] != NO_SLOT) && readRecord(slot[block], key, seq, stored) && (memcmp(data, stored, BLOCK_SIZE) == 0)) continue;
+
+        append(block, data);
+        written++;
+    };
+    return written;
+};
+
+void PersistLog::format(void)
+{
+    for (uint16_t index = 0; index < slot_count; ++index)
+    {
+        store.write(index * RECORD_SIZE,     static_cast<uint8_t>(NO_KEY));
+        store.write(index * RECORD_SIZE + 1, static_cast<uint8_t>(NO_KEY >> 8));
+    };
+    for (uint16_t block = 0; block < PERSIST_BLOCKS; ++block) slot[block] = NO_SLOT;
+    sequence = 0;
+    head     = 0;
+    cursor   = 0;
+};
+
+#endif
@@ -0,0 +1,69 @@
+// device-state that survives a reboot (PERSIST_ENABLE in config)
+// the state of every attached slave is cut into blocks of 8 byte, a changed block gets appended as record to a log in a PersistStore
+// record: key (block, 16bit), 32bit sequence, 8 byte data, inverted crc8 -> a torn write fails the crc, the older record of the block stays valid
+// erased (0xFF) and zeroed stores hold no valid record, so a new store needs no format()
+// capacity: PERSIST_BLOCKS in config and half of the records that fit into the store, whatever is smaller (see getBlocksFree())
+// wear-leveling: the log is a ring, appending skips the slots holding the newest record of a block, so rewrites spread over all free slots
+
+#ifndef ONEWIREHUB_PERSIST_H
+#define ONEWIREHUB_PERSIST_H
+
+#include "OneWireItem.h"
+
+#if PERSIST_ENABLE
+
+// non-volatile memory for the log, e.g. the eeprom of the mcu (EEPROM.read() / EEPROM.update()) or a file on the host
+class PersistStore
+{
+public:
+
+    virtual uint16_t getSize(void) const = 0;
+    virtual uint8_t  read(const uint16_t address) const = 0;
+    virtual void     write(const uint16_t address, const uint8_t value) = 0; // should skip unchanged bytes to save wear
+};
+
+class PersistLog
+{
+private:
+
+    static constexpr uint8_t  BLOCK_SIZE    = 8;
+    static constexpr uint8_t  RECORD_SIZE   = 2 + 4 + BLOCK_SIZE + 1; // key, sequence, data, inverted crc8
+    static constexpr uint16_t NO_SLOT       = 0xFFFF;
+    static constexpr uint16_t NO_KEY        = 0xFFFF;                 // erased eeprom never holds a valid record
+
+    PersistStore &  store;
+    uint16_t        slot_count;
+
+    OneWireItem *   item[HUB_SLAVE_LIMIT];
+    uint16_t        item_block[HUB_SLAVE_LIMIT + 1]; // first block of every item, the last entry ends the list
+    uint16_t        item_size[HUB_SLAVE_LIMIT];      // persisted bytes of the state
+    uint8_t         item_count;
+
+    uint16_t        slot[PERSIST_BLOCKS];            // newest record of every block, NO_SLOT if there is none
+    uint32_t        sequence;                        // of the next record
+    uint16_t        head;                            // next slot to try
+    uint16_t        cursor;                          // next block to check in flush()
+
+    bool     readRecord(const uint16_t index, uint16_t &key, uint32_t &seq, uint8_t data[]) const; // false if the crc fails
+    bool     isLive(const uint16_t index) const;
+    uint8_t  locate(const uint16_t block, uint16_t &offset, uint8_t &length) const; // returns the item holding the block
+    void     append(const uint16_t block, const uint8_t data[]);
+
+public:
+
+    explicit PersistLog(PersistStore &persist_store);
+
+    bool     attach(OneWireItem &source, const uint16_t length = 0xFFFF); // persist the first length bytes of the state, attach in the same order on every boot
+                                                                          // false if the state needs more than getBlocksFree() blocks of 8 byte (or after restore())
+    uint16_t restore(void);                    // loads the newest record of every block into the slaves, returns the restored blocks - call in setup() after attach()
+    uint16_t flush(const uint16_t blocks = 1); // compares this many blocks with their record and appends the changed ones, returns records written - call in loop(), never during bus-activity
+    void     format(void);                     // invalidates every record
+
+    uint16_t getBlocksFree(void) const;        // blocks left for attach(), min(PERSIST_BLOCKS, records of the store / 2) minus the attached ones
+
+    uint32_t getSequence(void) const { return sequence; }; // records written since format(), a measure for the wear
+};
+
+#endif
+
+#endif
@@ -0,0 +1,309 @@
+#include "OneWireHub_topology.h"
+
+#if !defined(ARDUINO)
+
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+
+#include "BAE910.h"
+#include "DS18B20.h"
+#include "DS2401.h"
+#include "DS2405.h"
+#include "DS2408.h"
+#include "DS2413.h"
+#include "DS2423.h"
+#include "DS2431.h"
+#include "DS2433.h"
+#include "DS2438.h"
+#include "DS2450.h"
+#include "DS2502.h"
+#include "DS2506.h"
+#include "DS2890.h"
+#include "HubDiag.h"
+
+template <typename device_t>
+static OneWireItem * constructDevice(void * place, const uint8_t id[])
+{
+    return new (place) device_t(id[0], id[1], id[2], id[3], id[4], id[5], id[6]);
+};
+
+template <typename device_t>
+static bool setDeviceTemperature(OneWireItem &device, const float value_degC)
+{
+    static_cast<device_t &>(device).setTemperature(value_degC);
+    return true;
+};
+
+template <typename device_t>
+static bool writeDeviceMemory(OneWireItem &device, const uint16_t address, const uint8_t data[], const uint8_t length)
+{
+    return static_cast<device_t &>(device).writeMemory(data, length, address);
+};
+
+#define DEVICE_TYPE(code, device_t) code, sizeof(device_t), alignof(device_t), constructDevice<device_t>
+
+static const DeviceType device_types[] =
+{
+    // family code, size, align, constructor, temperature, memory
+    { DEVICE_TYPE(0x28, DS18B20), setDeviceTemperature<DS18B20>, nullptr },
+    { DEVICE_TYPE(0x22, DS18B20), setDeviceTemperature<DS18B20>, nullptr },
+    { DEVICE_TYPE(0x10, DS18B20), setDeviceTemperature<DS18B20>, nullptr },
+    { DEVICE_TYPE(0x01, DS2401),  nullptr, nullptr },
+    { DEVICE_TYPE(0x05, DS2405),  nullptr, nullptr },
+    { DEVICE_TYPE(0x29, DS2408),  nullptr, nullptr },
+    { DEVICE_TYPE(0x3A, DS2413),  nullptr, nullptr },
+    { DEVICE_TYPE(0x1D, DS2423),  nullptr, writeDeviceMemory<DS2423> },
+    { DEVICE_TYPE(0x2D, DS2431),  nullptr, writeDeviceMemory<DS2431> },
+    { DEVICE_TYPE(0x23, DS2433),  nullptr, writeDeviceMemory<DS2433> },
+    { DEVICE_TYPE(0x26, DS2438),  setDeviceTemperature<DS2438>, writeDeviceMemory<DS2438> },
+    { DEVICE_TYPE(0x20, DS2450),  nullptr, nullptr },
+    { DEVICE_TYPE(0x11, DS2501),  nullptr, writeDeviceMemory<DS2501> },
+    { DEVICE_TYPE(0x91, DS2501),  nullptr, writeDeviceMemory<DS2501> },
+    { DEVICE_TYPE(0x09, DS2502),  nullptr, writeDeviceMemory<DS2502> },
+    { DEVICE_TYPE(0x89, DS2502),  nullptr, writeDeviceMemory<DS2502> },
+    { DEVICE_TYPE(0x13, DS2503),  nullptr, writeDeviceMemory<DS2503> },
+    { DEVICE_TYPE(0x0B, DS2505),  nullptr, writeDeviceMemory<DS2505> },
+    { DEVICE_TYPE(0x0F, DS2506),  nullptr, writeDeviceMemory<DS2506> },
+    { DEVICE_TYPE(0x2C, DS2890),  nullptr, nullptr },
+    { DEVICE_TYPE(0xFC, BAE910),  nullptr, nullptr },
+    { DEVICE_TYPE(0xFD, HubDiag), nullptr, nullptr },
+};
+
+#undef DEVICE_TYPE
+
+static constexpr uint8_t MEM_VALUE_LIMIT = 64; // bytes of one mem=
+
+static bool isBlank(const char c) { return (c == ' ') || (c == '\t') || (c == '\r'); };
+static bool isEnd(const char c)   { return (c == '\0') || (c == '\n') || (c == '#'); };
+
+static void skipBlank(const char * &text)
+{
+    while (isBlank(*text)) text++;
+};
+
+static bool parseNibble(const char c, uint8_t &value)
+{
+    if ((c >= '0') && (c <= '9'))       value = static_cast<uint8_t>(c - '0');
+    else if ((c >= 'a') && (c <= 'f'))  value = static_cast<uint8_t>(c - 'a' + 10);
+    else if ((c >= 'A') && (c <= 'F'))  value = static_cast<uint8_t>(c - 'A' + 10);
+    else return false;
+    return true;
+};
+
+static bool parseHex(const char * &text, uint8_t &value) // two digits
+{
+    uint8_t high, low;
+    if (!parseNibble(text[0], high) || !parseNibble(text[1], low)) return false;
+    value = static_cast<uint8_t>((high << 4) | low);
+    text += 2;
+    return true;
+};
+
+static bool parseKey(const char * &text, const char key[])
+{
+    uint8_t length = 0;
+    while (key[length] != '\0')
+    {
+        if (text[length] != key[length]) return false;
+        length++;
+    };
+    text += length;
+    return true;
+};
+
+
+Topology::Topology(uint8_t buffer[], const uint32_t size) : arena(buffer), arena_size(size), arena_used(0), type_count(0),
+    hub_list(nullptr), hub_count(0), device_list(nullptr), device_count(0), hub_first(0), error_line(0)
+{
+};
+
+bool Topology::addType(const DeviceType &type)
+{
+    if (type_count >= TYPE_LIMIT)   return false;
+    if (type.construct == nullptr)  return false;
+    types[type_count++] = type;
+    return true;
+};
+
+const DeviceType * Topology::findType(const uint8_t family_code) const
+{
+    for (uint8_t i = 0; i < type_count; ++i)
+    {
+        if (types[i].family_code == family_code) return &types[i];
+    };
+    for (const DeviceType &type : device_types)
+    {
+        if (type.family_code == family_code) return &type;
+    };
+    return nullptr;
+};
+
+void * Topology::allocate(const uint32_t size, const uint8_t align)
+{
+    const uintptr_t address = reinterpret_cast<uintptr_t>(&arena[arena_used]);
+    const uint32_t  padding = static_cast<uint32_t>((align - (address % align)) % align);
+    if ((arena_used + padding + size) > arena_size) return nullptr;
+    void * const place = &arena[arena_used + padding];
+    arena_used += padding + size;
+    return place;
+};
+
+bool Topology::startHub(const uint8_t pin, const bool build)
+{
+    if (build)
+    {
+        attachHub();
+        void * const place = allocate(sizeof(OneWireHub), alignof(OneWireHub));
+        if (place == nullptr) return false;
+        hub_list[hub_count] = new (place) OneWireHub(pin);
+    };
+    hub_count++;
+    hub_first = device_count;
+    return true;
+};
+
+void Topology::attachHub(void)
+{
+    if (hub_count == 0) return;
+    hub_list[hub_count - 1]->attach(&device_list[hub_first], static_cast<uint8_t>(device_count - hub_first));
+};
+
+bool Topology::parseLine(const char * &text, const bool build)
+{
+    skipBlank(text);
+
+    if (parseKey(text, "hub"))
+    {
+        skipBlank(text);
+        uint8_t pin = 0;
+        while ((*text >= '0') && (*text <= '9')) pin = static_cast<uint8_t>((pin * 10) + (*text++ - '0'));
+        if (!startHub(pin, build)) return false;
+    }
+    else if (!isEnd(*text))
+    {
+        uint8_t id[7];
+        for (uint8_t i = 0; i < 7; ++i)
+        {
+            skipBlank(text);
+            if (!parseHex(text, id[i])) return false;
+        };
+
+        const DeviceType * const type = findType(id[0]);
+        if (type == nullptr)                                    return false; // unknown family code
+        if ((hub_count == 0) && !startHub(0, build))            return false; // devices before the first hub get one
+        if ((device_count - hub_first) >= HUB_SLAVE_LIMIT)      return false; // hub is full
+
+        OneWireItem * device = nullptr;
+        if (build)
+        {
+            void * const place = allocate(type->size, type->align);
+            if (place == nullptr) return false;
+            device = type->construct(place, id);
+            device_list[device_count] = device;
+        };
+        device_count++;
+
+        // initial values
+        while (true)
+        {
+            skipBlank(text);
+            if (isEnd(*text)) break;
+
+            if (parseKey(text, "temp="))
+            {
+                char * end;
+                const float value = strtof(text, &end);
+                if ((end == text) || (type->setTemperature == nullptr)) return false;
+                text = end;
+                if (build) type->setTemperature(*device, value);
+            }
+            else if (parseKey(text, "mem="))
+            {
+                uint8_t address[2], data[MEM_VALUE_LIMIT], length = 0;
+                if (!parseHex(text, address[0]) || !parseHex(text, address[1]) || (*text++ != ':')) return false;
+                while ((length < MEM_VALUE_LIMIT) && parseHex(text, data[length])) length++;
+                if ((length == 0) || (type->writeMemory == nullptr)) return false;
+                if (build) type->writeMemory(*device, static_cast<uint16_t>((address[0] << 8) | address[1]), data, length);
+            }
+            else return false;
+
+            if (!isBlank(*text) && !isEnd(*text)) return false;
+        };
+    };
+
+    skipBlank(text);
+    if (*text == '#') while ((*text != '\0') && (*text != '\n')) text++; // comment
+    if (*text == '\n') text++;
+    else if (*text != '\0') return false;
+    return true;
+};
+
+bool Topology::parse(const char text[])
+{
+    arena_used  = 0;
+    hub_list    = nullptr;
+    device_list = nullptr;
+    error_line  = 0;
+
+    // first pass checks and counts, so the lists get their exact size
+    for (uint8_t pass = 0; pass < 2; ++pass)
+    {
+        const bool build = (pass == 1);
+        hub_count    = 0;
+        device_count = 0;
+        hub_first    = 0;
+
+        const char * cursor = text;
+        uint32_t     line   = 0;
+        while (*cursor != '\0')
+        {
+            line++;
+            if (!parseLine(cursor, build))
+            {
+                error_line = line;
+                if (build) attachHub();
+                return false;
+            };
+        };
+
+        if (build)
+        {
+            attachHub();
+        }
+        else
+        {
+            hub_list    = static_cast<OneWireHub **>(allocate(hub_count * sizeof(OneWireHub *), alignof(OneWireHub *)));
+            device_list = static_cast<OneWireItem **>(allocate(device_count * sizeof(OneWireItem *), alignof(OneWireItem *)));
+            if ((hub_list == nullptr) || (device_list == nullptr))
+            {
+                error_line = line;
+                return false;
+            };
+        };
+    };
+    return true;
+};
+
+bool Topology::load(const char path[])
+{
+    FILE * const file = fopen(path, "rb");
+    if (file == nullptr) return false;
+
+    bool success = false;
+    if (fseek(file, 0, SEEK_END) == 0)
+    {
+        const long size = ftell(file);
+        char * const text = (size >= 0) ? new char[size + 1] : nullptr;
+        if ((text != nullptr) && (fseek(file, 0, SEEK_SET) == 0) && (fread(text, 1, size_t(size), file) == size_t(size)))
+        {
+            text[size] = '\0';
+            success = parse(text);
+        };
+        delete[] text;
+    };
+    fclose(file);
+    return success;
+};
+
+#endif
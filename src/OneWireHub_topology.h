@@ -0,0 +1,75 @@
+// device-factory and topology-loader for the host-build: big simulated installations come from a text-file instead of hand-written globals
+// the factory maps family codes to constructors, the loader places hubs and devices in one pre-sized arena and attaches each hub in one batch
+// topology-file, one entry per line, '#' starts a comment:
+//   hub [pin]                                            starts a new hub, the following devices get attached to it (max HUB_SLAVE_LIMIT)
+//   28 0D 01 08 0B 02 00 [temp=21.5] [mem=0010:DEADBEEF] device: family code and 6 serial-bytes in hex, the crc gets calculated
+//   temp= sets thermometers (ds18b20, ds2438), mem=address:bytes goes through writeMemory() of the memory-devices
+
+#ifndef ONEWIREHUB_TOPOLOGY_H
+#define ONEWIREHUB_TOPOLOGY_H
+
+#include "OneWireItem.h"
+
+#if !defined(ARDUINO)
+
+// constructor and setters of one device-type, the built-in table covers every device of the library
+struct DeviceType
+{
+    uint8_t       family_code;
+    uint16_t      size;                                                             // bytes in the arena
+    uint8_t       align;
+    OneWireItem * (*construct)(void * place, const uint8_t id[]);                   // placement-new with family code and 6 serial-bytes
+    bool          (*setTemperature)(OneWireItem &device, const float value_degC);   // nullptr if the device has no thermometer
+    bool          (*writeMemory)(OneWireItem &device, const uint16_t address, const uint8_t data[], const uint8_t length); // nullptr if the device has no memory
+};
+
+class Topology
+{
+private:
+
+    static constexpr uint8_t TYPE_LIMIT = 16; // own types of addType()
+
+    uint8_t *       arena;
+    uint32_t        arena_size;
+    uint32_t        arena_used;
+
+    DeviceType      types[TYPE_LIMIT];
+    uint8_t         type_count;
+
+    OneWireHub **   hub_list;
+    uint16_t        hub_count;
+    OneWireItem **  device_list;
+    uint32_t        device_count;
+    uint32_t        hub_first;      // first device of the last hub
+    uint32_t        error_line;
+
+    void *  allocate(const uint32_t size, const uint8_t align); // nullptr if the arena is exhausted
+    bool    parseLine(const char * &text, const bool build);    // build == false only counts and checks
+    bool    startHub(const uint8_t pin, const bool build);
+    void    attachHub(void);                                    // the devices of the last hub in one batch
+
+public:
+
+    Topology(uint8_t buffer[], const uint32_t size);
+
+    Topology(const Topology &) = delete;
+    Topology & operator=(const Topology &) = delete;
+
+    bool     addType(const DeviceType &type);                   // own devices or other family codes, checked before the built-in types
+    const DeviceType * findType(const uint8_t family_code) const;
+
+    bool     load(const char path[]);  // reads the whole file and parses it
+    bool     parse(const char text[]); // builds hubs and devices, false on errors (see getErrorLine()) - reuses the arena, objects of an earlier parse are gone
+
+    uint16_t      getHubCount(void) const { return hub_count; };
+    OneWireHub *  getHub(const uint16_t index) const { return (index < hub_count) ? hub_list[index] : nullptr; };
+    uint32_t      getDeviceCount(void) const { return device_count; };
+    OneWireItem * getDevice(const uint32_t index) const { return (index < device_count) ? device_list[index] : nullptr; };
+
+    uint32_t getArenaUsed(void) const { return arena_used; };
+    uint32_t getErrorLine(void) const { return error_line; }; // 0 if there was no error
+};
+
+#endif
+
+#endif
@@ -25,6 +25,29 @@ public:
 
     virtual void duty(OneWireHub * const hub) = 0;
 
+    bool hasAlarm(void) const { return alarm_flag; }; // only slaves with a raised flag take part in an alarm search (0xEC), the search only reads it
+
+    virtual void updateAlarm(void) { }; // gets called by poll() outside of bus-activity, slaves with alarms finish due work (e.g. a conversion) here and set alarm_flag
+
+#if STATE_ENABLE
+    // device-state that survives a reboot (see PersistLog) or goes into a snapshot, gets called from loop(), never during bus-activity
+    virtual uint16_t getStateSize(void) const { return 0; };
+    virtual void     readState(const uint16_t, uint8_t [], const uint8_t) const { };
+    virtual void     writeState(const uint16_t, const uint8_t [], const uint8_t) { };
+#endif
+
+#if SNAPSHOT_ENABLE
+    // state for a snapshot: the persistent state, devices with volatile state (scratchpad, running conversion) append it here, so PersistLog never writes it
+    virtual uint16_t getSnapshotSize(void) const { return getStateSize(); };
+    virtual void     readSnapshot(const uint16_t position, uint8_t destination[], const uint8_t length) const { readState(position, destination, length); };
+    virtual void     writeSnapshot(const uint16_t position, const uint8_t source[], const uint8_t length) { writeState(position, source, length); };
+#endif
+
+#if JOURNAL_ENABLE
+    // applies a committed write of the master again (see replayJournal()), command and address as recorded by the duty() of this device
+    virtual bool replayWrite(const uint8_t, const uint16_t, const uint8_t [], const uint8_t) { return false; };
+#endif
+
     static uint8_t crc8(const uint8_t address[], const uint8_t len, const uint8_t init = 0);
 
     // takes ~(5.1-7.0)µs/byte (Atmega328P@16MHz) depends from address_size (see debug-crc-comparison.ino)
@@ -36,6 +59,795 @@ public:
     // important: the final crc is expected to be inverted (crc=~crc) !!!
     static uint16_t crc16(uint8_t value, uint16_t crc);
 
+protected:
+
+    volatile bool alarm_flag; // read by the alarm search, so the device keeps it current outside of it (updateAlarm(), duty(), getters)
+
+};
+
+
+// compile-time choice between two types (avr-gcc offers no std::conditional), the storage of a device depends on its template-parameters
+template <bool CONDITION, typename true_t, typename false_t>
+struct SelectType { using type = true_t; };
+
+template <typename true_t, typename false_t>
+struct SelectType<false, true_t, false_t> { using type = false_t; };
+
+
+// external memory for the memory-devices (the Backed-variants like DS2433Backed): spi-fram, flash, a host-file or pages computed on demand
+// all hooks get called from duty() during bus-activity, a page has to be ready within a few bit-slots
+class MemoryBackend
+{
+public:
+
+    virtual bool readRange(const uint16_t position, uint8_t destination[], const uint16_t length) = 0;  // returns false if the data is not available
+    virtual bool writeRange(const uint16_t position, const uint8_t source[], const uint16_t length) = 0;
+    virtual const uint8_t * getPage(const uint16_t, const uint8_t) { return nullptr; }; // direct pointer for memory-mapped storage, saves the copy
+};
+
+// memory of a device, SIZE bytes organized in pages of PAGE_SIZE, BACKEND is chosen per device
+// the backend-version keeps one page in a buffer, without backend everything reads as 0xFF (erased) and writes get lost
+template <uint16_t SIZE, uint8_t PAGE_SIZE, bool BACKEND = false>
+class MemoryStorage
+{
+private:
+
+    static constexpr uint16_t NO_PAGE = 0xFFFF;
+
+    MemoryBackend *     backend;
+    mutable uint8_t     buffer[PAGE_SIZE];
+    mutable uint16_t    buffer_page;        // page in the buffer, NO_PAGE if invalid
+
+    const uint8_t * loadPage(const uint16_t page) const
+    {
+        if (page == buffer_page) return buffer;
+        const uint16_t position = page * PAGE_SIZE;
+        const uint16_t length   = ((SIZE - position) < PAGE_SIZE) ? (SIZE - position) : PAGE_SIZE;
+        if ((backend == nullptr) || !backend->readRange(position, buffer, length)) memset(buffer, static_cast<uint8_t>(0xFF), PAGE_SIZE);
+        buffer_page = page;
+        return buffer;
+    };
+
+public:
+
+    MemoryStorage(void) : backend(nullptr), buffer_page(NO_PAGE) {};
+
+    bool setBackend(MemoryBackend &memory_backend) { backend = &memory_backend; buffer_page = NO_PAGE; return true; };
+
+    bool setImage(const uint8_t image[]) // copies the PROGMEM-array of SIZE bytes into the backend
+    {
+        for (uint16_t position = 0; position < SIZE; position += PAGE_SIZE)
+        {
+            const uint8_t length = ((SIZE - position) < PAGE_SIZE) ? (SIZE - position) : PAGE_SIZE;
+            for (uint8_t i = 0; i < length; ++i) buffer[i] = pgm_read_byte(&image[position + i]);
+            write(position, buffer, length);
+        };
+        return true;
+    };
+
+    bool    isWritable(const uint16_t) const { return true; };
+    uint8_t getPoolUsed(void) const { return 0; };
+
+    const uint8_t * getPage(const uint16_t page) const // valid till the next access
+    {
+        if (backend != nullptr)
+        {
+            const uint8_t * const mapped = backend->getPage(page, PAGE_SIZE);
+            if (mapped != nullptr) return mapped;
+        };
+        return loadPage(page);
+    };
+
+    uint8_t read(const uint16_t position) const { return getPage(position / PAGE_SIZE)[position % PAGE_SIZE]; };
+
+    void read(const uint16_t position, uint8_t destination[], const uint16_t length) const
+    {
+        for (uint16_t i = 0; i < length; ++i) destination[i] = read(position + i);
+    };
+
+    void write(const uint16_t position, const uint8_t source[], const uint16_t length)
+    {
+        if (length == 0) return;
+        if (backend != nullptr) backend->writeRange(position, source, length);
+        buffer_page = NO_PAGE; // cheaper than a partial update
+    };
+
+    void write(const uint16_t position, const uint8_t value) { write(position, &value, 1); };
+
+    void fill(const uint8_t value)
+    {
+        for (uint16_t position = 0; position < SIZE; position += PAGE_SIZE)
+        {
+            memset(buffer, value, PAGE_SIZE);
+            write(position, buffer, ((SIZE - position) < PAGE_SIZE) ? (SIZE - position) : PAGE_SIZE);
+        };
+    };
+};
+
+template <uint16_t SIZE, uint8_t PAGE_SIZE>
+class MemoryStorage<SIZE, PAGE_SIZE, false> // plain RAM-array, every method boils down to an array-access
+{
+private:
+
+    uint8_t memory[SIZE];
+
+public:
+
+    bool setBackend(MemoryBackend &) { return false; };
+
+    bool setImage(const uint8_t image[]) // copies the PROGMEM-array of SIZE bytes into RAM
+    {
+        for (uint16_t i = 0; i < SIZE; ++i) memory[i] = pgm_read_byte(&image[i]);
+        return true;
+    };
+
+    bool    isWritable(const uint16_t) const { return true; };
+    uint8_t getPoolUsed(void) const { return 0; };
+
+    const uint8_t * getPage(const uint16_t page) const { return &memory[page * PAGE_SIZE]; };
+
+    uint8_t read(const uint16_t position) const { return memory[position]; };
+    void    read(const uint16_t position, uint8_t destination[], const uint16_t length) const { memcpy(destination, &memory[position], length); };
+
+    void    write(const uint16_t position, const uint8_t source[], const uint16_t length) { memcpy(&memory[position], source, length); };
+    void    write(const uint16_t position, const uint8_t value) { memory[position] = value; };
+
+    void    fill(const uint8_t value) { memset(memory, value, SIZE); };
+};
+
+// sparse memory for big eproms (PAGE_POOL_ENABLE in config), same interface as MemoryStorage
+// pages start erased (0xFF) and share one read-only page, the first write of a page takes one of POOL_PAGES from the pool
+// with setImage() the pages start with the content of a flash-image (PROGMEM) instead, the pool becomes a copy-on-write overlay
+// also replaces the PageCRC of the device: crcs are kept for the pool-pages, all erased pages share one precomputed crc16
+template <uint16_t SIZE, uint8_t PAGE_SIZE, uint8_t POOL_PAGES>
+class PagePool
+{
+private:
+
+    static constexpr uint16_t PAGE_COUNT    = (SIZE + PAGE_SIZE - 1) / PAGE_SIZE;
+    static constexpr uint16_t NO_PAGE       = 0xFFFF;
+    static constexpr uint8_t  NO_SLOT       = 0xFF;
+
+    static uint8_t erased[PAGE_SIZE];       // shared by all pools of this size
+
+    const uint8_t *  image;                 // base in PROGMEM, nullptr for erased pages
+    mutable uint8_t  buffer[PAGE_SIZE];     // image-page that was read last
+    mutable uint16_t buffer_page;
+
+    uint8_t  pool[POOL_PAGES][PAGE_SIZE];
+    uint8_t  slot[PAGE_COUNT];              // pool-slot of every page, NO_SLOT while it shows the base
+    uint8_t  slots_used;
+    uint16_t crc[POOL_PAGES];
+    uint8_t  dirty[(POOL_PAGES + 7) / 8];   // per slot
+    uint16_t erased_crc;
+
+    bool isDirtySlot(const uint8_t index) const { return ((dirty[index >> 3] >> (index & 7)) & uint8_t(1)) != 0; };
+
+    const uint8_t * loadBase(const uint16_t page) const
+    {
+        if (image == nullptr)       return erased;
+        if (page == buffer_page)    return buffer;
+        const uint16_t position = page * PAGE_SIZE;
+        const uint8_t  length   = ((SIZE - position) < PAGE_SIZE) ? (SIZE - position) : PAGE_SIZE;
+        for (uint8_t i = 0; i < length; ++i) buffer[i] = pgm_read_byte(&image[position + i]);
+        memset(&buffer[length], static_cast<uint8_t>(0xFF), PAGE_SIZE - length);
+        buffer_page = page;
+        return buffer;
+    };
+
+public:
+
+    PagePool(void) : image(nullptr), buffer_page(NO_PAGE), slots_used(0)
+    {
+        static_assert(POOL_PAGES < NO_SLOT, "Pool is too big");
+        memset(erased, static_cast<uint8_t>(0xFF), PAGE_SIZE);
+        memset(slot, NO_SLOT, PAGE_COUNT);
+        erased_crc = OneWireItem::crc16(erased, PAGE_SIZE, 0);
+        setDirty();
+    };
+
+    bool    setBackend(MemoryBackend &) { return false; };
+
+    bool    setImage(const uint8_t base[]) // PROGMEM-array of SIZE bytes, drops all modified pages
+    {
+        image       = base;
+        buffer_page = NO_PAGE;
+        fill(0xFF);
+        return true;
+    };
+
+    bool    isWritable(const uint16_t page) const { return (page < PAGE_COUNT) && ((slot[page] != NO_SLOT) || (slots_used < POOL_PAGES)); };
+    uint8_t getPoolUsed(void) const { return slots_used; };
+
+    const uint8_t * getPage(const uint16_t page) const { return (slot[page] == NO_SLOT) ? loadBase(page) : pool[slot[page]]; };
+
+    uint8_t read(const uint16_t position) const { return getPage(position / PAGE_SIZE)[position % PAGE_SIZE]; };
+
+    void read(const uint16_t position, uint8_t destination[], const uint16_t length) const
+    {
+        for (uint16_t i = 0; i < length; ++i) destination[i] = read(position + i);
+    };
+
+    void write(const uint16_t position, const uint8_t value) // gets lost if the pool is exhausted
+    {
+        const uint16_t page = position / PAGE_SIZE;
+        if (slot[page] == NO_SLOT)
+        {
+            const uint8_t * const base = loadBase(page);
+            if ((value == base[position % PAGE_SIZE]) || (slots_used >= POOL_PAGES)) return; // stays with the base
+            slot[page] = slots_used++;
+            memcpy(pool[slot[page]], base, PAGE_SIZE);
+            setDirty(page);
+        };
+        pool[slot[page]][position % PAGE_SIZE] = value;
+    };
+
+    void write(const uint16_t position, const uint8_t source[], const uint16_t length)
+    {
+        for (uint16_t i = 0; i < length; ++i) write(position + i, source[i]);
+    };
+
+    void fill(const uint8_t value) // returns every page to the pool, with an image all pages show it again and value is ignored
+    {
+        memset(slot, NO_SLOT, PAGE_COUNT);
+        slots_used = 0;
+        if ((value == 0xFF) || (image != nullptr)) return;
+        for (uint16_t position = 0; position < SIZE; ++position) write(position, value);
+    };
+
+    // PageCRC-interface
+    void setDirty(void)
+    {
+        memset(dirty, static_cast<uint8_t>(0xFF), sizeof(dirty));
+    };
+
+    void setDirty(const uint16_t page)
+    {
+        if ((page < PAGE_COUNT) && (slot[page] != NO_SLOT)) dirty[slot[page] >> 3] |= uint8_t(1) << (slot[page] & 7);
+    };
+
+    void setDirty(const uint16_t position, const uint16_t length)
+    {
+        if (length == 0) return;
+        const uint16_t page_stop = (position + length - 1) / PAGE_SIZE;
+        for (uint16_t page = position / PAGE_SIZE; page <= page_stop; ++page) setDirty(page);
+    };
+
+    bool getCRC(const uint16_t page, uint16_t &value) const // image-pages are not cached, their crc gets calculated while sending
+    {
+        if (page >= PAGE_COUNT) return false;
+        const uint8_t index = slot[page];
+        if (index != NO_SLOT)
+        {
+            if (isDirtySlot(index)) return false;
+            value = crc[index];
+        }
+        else
+        {
+            if (image != nullptr)   return false;
+            value = erased_crc;
+        };
+        return true;
+    };
+
+    void setCRC(const uint16_t page, const uint16_t value)
+    {
+        if ((page >= PAGE_COUNT) || (slot[page] == NO_SLOT)) return;
+        const uint8_t index = slot[page];
+        crc[index] = value;
+        dirty[index >> 3] &= ~(uint8_t(1) << (index & 7));
+    };
+
+    void update(const PagePool &) // the pool is its own memory
+    {
+        for (uint8_t index = 0; index < slots_used; ++index)
+        {
+            if (!isDirtySlot(index)) continue;
+            crc[index] = OneWireItem::crc16(pool[index], PAGE_SIZE, 0);
+            dirty[index >> 3] &= ~(uint8_t(1) << (index & 7));
+        };
+    };
+};
+
+template <uint16_t SIZE, uint8_t PAGE_SIZE, uint8_t POOL_PAGES>
+uint8_t PagePool<SIZE, PAGE_SIZE, POOL_PAGES>::erased[PAGE_SIZE];
+
+// keeps the crc of every memory-page, so page-aligned reads can send a stored crc instead of computing it bit by bit
+// crc_t selects the type: uint8_t for crc8, uint16_t for crc16 (stored not inverted, with init 0)
+// writes only mark pages dirty (cheap enough for duty()), update() recalculates them - call it outside of bus-activity
+template <typename crc_t, uint16_t PAGE_COUNT, uint8_t PAGE_SIZE>
+class PageCRC
+{
+private:
+
+    crc_t   crc[PAGE_COUNT];
+    uint8_t dirty[(PAGE_COUNT + 7) / 8];
+
+    static uint8_t  calcCRC(const uint8_t address[], const uint8_t init) { return OneWireItem::crc8(address, PAGE_SIZE, init); };
+    static uint16_t calcCRC(const uint8_t address[], const uint16_t init) { return OneWireItem::crc16(address, PAGE_SIZE, init); };
+
+public:
+
+    PageCRC(void)
+    {
+        setDirty();
+    };
+
+    template <typename storage_t>
+    explicit PageCRC(const storage_t &) : PageCRC() {}; // same initializer as a reference to a PagePool, that keeps the crcs itself
+
+    void setDirty(void)
+    {
+        memset(dirty, static_cast<uint8_t>(0xFF), sizeof(dirty));
+    };
+
+    void setDirty(const uint16_t page)
+    {
+        if (page < PAGE_COUNT) dirty[page >> 3] |= uint8_t(1) << (page & 7);
+    };
+
+    void setDirty(const uint16_t position, const uint16_t length)
+    {
+        if (length == 0) return;
+        const uint16_t page_stop = (position + length - 1) / PAGE_SIZE;
+        for (uint16_t page = position / PAGE_SIZE; page <= page_stop; ++page) setDirty(page);
+    };
+
+    bool isDirty(const uint16_t page) const
+    {
+        if (page >= PAGE_COUNT) return true;
+        return ((dirty[page >> 3] >> (page & 7)) & uint8_t(1)) != 0;
+    };
+
+    bool isDirty(void) const // any page
+    {
+        for (uint16_t page = 0; page < PAGE_COUNT; ++page)
+        {
+            if (isDirty(page)) return true;
+        };
+        return false;
+    };
+
+    bool getCRC(const uint16_t page, crc_t &value) const // returns 0 if the page has to be calculated
+    {
+        if (isDirty(page)) return false;
+        value = crc[page];
+        return true;
+    };
+
+    void setCRC(const uint16_t page, const crc_t value) // store a crc that was calculated during a readout
+    {
+        if (page >= PAGE_COUNT) return;
+        crc[page] = value;
+        dirty[page >> 3] &= ~(uint8_t(1) << (page & 7));
+    };
+
+    void update(const uint8_t memory[]) // recalculate all dirty pages of memory[PAGE_COUNT*PAGE_SIZE]
+    {
+        for (uint16_t page = 0; page < PAGE_COUNT; ++page)
+        {
+            if (isDirty(page)) setCRC(page, calcCRC(&memory[page * PAGE_SIZE], crc_t(0)));
+        };
+    };
+
+    template <uint16_t SIZE, bool BACKEND>
+    void update(const MemoryStorage<SIZE, PAGE_SIZE, BACKEND> &storage) // same for a device-memory, loads only the dirty pages
+    {
+        for (uint16_t page = 0; page < PAGE_COUNT; ++page)
+        {
+            if (isDirty(page)) setCRC(page, calcCRC(storage.getPage(page), crc_t(0)));
+        };
+    };
+
+    template <uint16_t SIZE, uint8_t POOL_PAGES>
+    void update(const PagePool<SIZE, PAGE_SIZE, POOL_PAGES> &storage) // for crc8-devices on a flash-image
+    {
+        for (uint16_t page = 0; page < PAGE_COUNT; ++page)
+        {
+            if (isDirty(page)) setCRC(page, calcCRC(storage.getPage(page), crc_t(0)));
+        };
+    };
+};
+
+// resolved page-redirection of the add-only eproms (ds2502, ds2506), keeps the final destination of every page
+// the status holds one hop per page as ones complement (0xFF: none), the datasheet makes the redirection recursive
+// a chain ends at a page without redirection or outside of PAGE_COUNT (fake data), a chain that runs into a loop is ignored
+// update() resolves all pages in one pass - call it when the redirection-bytes change, getPage() is a plain array-access for duty()
+template <uint16_t PAGE_COUNT>
+class PageRedirection
+{
+private:
+
+    static constexpr uint8_t BITMAP_SIZE = (PAGE_COUNT + 7) / 8;
+
+    uint8_t destination[PAGE_COUNT];
+
+    static bool getBit(const uint8_t bitmap[], const uint16_t page) { return ((bitmap[page >> 3] >> (page & 7)) & uint8_t(1)) != 0; };
+    static void setBit(uint8_t bitmap[], const uint16_t page) { bitmap[page >> 3] |= uint8_t(1) << (page & 7); };
+
+    static uint16_t getNext(const uint8_t redirection[], const uint16_t page) // one hop, the page itself if not redirected
+    {
+        const uint8_t destin = ~redirection[page];
+        return (destin == 0x00) ? page : destin;
+    };
+
+public:
+
+    PageRedirection(void)
+    {
+        for (uint16_t page = 0; page < PAGE_COUNT; ++page) destination[page] = static_cast<uint8_t>(page);
+    };
+
+    uint16_t getPage(const uint16_t page) const
+    {
+        return (page < PAGE_COUNT) ? destination[page] : page;
+    };
+
+    void update(const uint8_t redirection[]) // redirection-bytes of the status, one per page
+    {
+        uint8_t seen[BITMAP_SIZE], done[BITMAP_SIZE], looped[BITMAP_SIZE];
+        memset(seen,   0, BITMAP_SIZE);
+        memset(done,   0, BITMAP_SIZE);
+        memset(looped, 0, BITMAP_SIZE);
+
+        for (uint16_t page = 0; page < PAGE_COUNT; ++page)
+        {
+            if (getBit(done, page)) continue;
+
+            // follow the chain till its end, a page resolved before or a page of this chain (loop)
+            uint16_t current = page, target = page;
+            bool     loop    = false;
+            while (true)
+            {
+                setBit(seen, current);
+                const uint16_t next = getNext(redirection, current);
+                if ((next == current) || (next >= PAGE_COUNT))  { target = next; break; };
+                if (getBit(done, next))                         { target = destination[next]; loop = getBit(looped, next); break; };
+                if (getBit(seen, next))                         { loop = true; break; };
+                current = next;
+            };
+
+            // every page of the chain shares the result, so each page gets visited once
+            current = page;
+            while ((current < PAGE_COUNT) && !getBit(done, current))
+            {
+                destination[current] = static_cast<uint8_t>(loop ? current : target);
+                setBit(done, current);
+                if (loop) setBit(looped, current);
+                current = getNext(redirection, current);
+            };
+        };
+    };
+};
+
+// source for OneWireHub::sendPages() that sends and feeds the stored crc16 of a PageCRC
+template <typename cache_t>
+class CachedPageSource : public PageSource
+{
+private:
+
+    cache_t &cache;
+
+public:
+
+    CachedPageSource(const uint8_t memory_start[], const uint16_t size, cache_t &page_crc) : PageSource(memory_start, size), cache(page_crc) {};
+
+    bool getCRC(const uint16_t page, uint16_t &crc) const { return cache.getCRC(page, crc); };
+    void setCRC(const uint16_t page, const uint16_t crc)  { cache.setCRC(page, crc); };
+};
+
+// same for a MemoryStorage, pages come from the storage instead of a plain array
+template <typename storage_t, typename cache_t>
+class StoragePageSource : public CachedPageSource<cache_t>
+{
+private:
+
+    const storage_t &storage;
+
+public:
+
+    StoragePageSource(const storage_t &memory, const uint16_t size, cache_t &page_crc) : CachedPageSource<cache_t>(nullptr, size, page_crc), storage(memory) {};
+
+    const uint8_t * getPage(const uint16_t page, const uint8_t page_size) const
+    {
+        return (page * page_size < this->memory_size) ? storage.getPage(page) : nullptr;
+    };
+};
+
+// device-state with a shadow-copy (DOUBLE_BUFFER_ENABLE in config), used by DS18B20, DS2438 and DS2450, T has to be a struct
+// setters change the shadow between edit() and publish() (crc included), publishing is a single write of the index
+// duty() reads a multi-byte readout from hold(), edit() keeps off that copy, so the readout never mixes old and new data - even if setters publish several times meanwhile
+// that needs a third copy: one published, one held by the bus, one for the setter
+// duty() has to call touch() after changing the state, a pending publish() fails then and the setter has to redo its edit
+template <typename T, bool ENABLE = DOUBLE_BUFFER_ENABLE>
+class DoubleBuffer
+{
+private:
+
+    T                buffer[3];
+    volatile uint8_t active;        // index of the published copy
+    volatile uint8_t held;          // index of the copy the bus reads, set by hold()
+    volatile uint8_t revision;      // changes with every touch()
+    uint8_t          revision_edit;
+    uint8_t          shadow;        // index of the copy between edit() and publish()
+
+public:
+
+    DoubleBuffer(void) : active(0), held(0), revision(0), revision_edit(0), shadow(1) {};
+
+    T &       get(void)       { return buffer[active]; }; // published copy
+    const T & get(void) const { return buffer[active]; };
+
+    T & hold(void) // only from duty(), published copy for a readout, stays valid till the next hold()
+    {
+        do { held = active; } while (held != active); // a setter in an interrupt could publish in between
+        return buffer[held];
+    };
+
+    void      touch(void)     { revision++; };
+
+    T & edit(void) // only for the application, never from duty()
+    {
+        revision_edit = revision;
+        const uint8_t current = active;
+        const uint8_t reading = held;
+        shadow = (current != reading) ? uint8_t(3 - current - reading) : uint8_t((current + 1) % 3); // neither published nor held
+        buffer[shadow] = buffer[current];
+        return buffer[shadow];
+    };
+
+    bool publish(void) // returns false if the bus changed the state since edit()
+    {
+        noInterrupts(); // just for the compare and the flip, not for the whole setter
+        const bool valid = (revision == revision_edit);
+        if (valid) active = shadow;
+        interrupts();
+        return valid;
+    };
+};
+
+template <typename T>
+class DoubleBuffer<T, false> // without shadow-copy every access goes to the same state
+{
+private:
+
+    T buffer;
+
+public:
+
+    T &       get(void)       { return buffer; };
+    const T & get(void) const { return buffer; };
+    T &       hold(void)      { return buffer; };
+    void      touch(void)     { };
+    T &       edit(void)      { return buffer; };
+    bool      publish(void)   { return true; };
+};
+
+
+// pull-model (PROVIDER_ENABLE in config): a conversion of the master requests a sample, the application answers with the usual setter of the device
+// the provider gets called from duty() during bus-activity, so it should only start the measurement (adc, i2c) and return
+// the setter has to follow within the conversion-window - from loop() if the master sleeps, otherwise from an interrupt or another task
+// a late sample is not lost, it just goes into the next readout
+using SampleProvider = void (*)(OneWireItem &device, const uint8_t channel, void * context);
+
+template <bool ENABLE = PROVIDER_ENABLE>
+class SampleRequest
+{
+private:
+
+    SampleProvider   provider;
+    void *           context;
+    uint32_t         start;     // millis() of the request
+    uint16_t         window;    // ms
+    volatile uint8_t pending;   // mask of the requested channels
+
+public:
+
+    SampleRequest(void) : provider(nullptr), context(nullptr), start(0), window(0), pending(0) {};
+
+    bool setProvider(const SampleProvider function, void * const data)
+    {
+        provider = function;
+        context  = data;
+        pending  = 0;
+        return true;
+    };
+
+    bool request(OneWireItem &device, const uint8_t channel_mask, const uint16_t window_ms) // false without provider
+    {
+        if (provider == nullptr) return false;
+        const bool expired = ((millis() - start) >= window);
+        noInterrupts(); // read-modify-write, a setter in an interrupt could complete a channel in between
+        if (expired) pending = 0;
+        pending |= channel_mask; // before the calls, a provider can answer right away
+        interrupts();
+        start   = millis();
+        window  = window_ms;
+        for (uint8_t channel = 0; channel < 8; ++channel)
+        {
+            if (channel_mask & (uint8_t(1) << channel)) provider(device, channel, context);
+        };
+        return true;
+    };
+
+    void complete(const uint8_t channel) // gets called by the setters, also from an interrupt
+    {
+        noInterrupts(); // read-modify-write on pending, like the setters guard their values
+        pending &= ~(uint8_t(1) << channel);
+        interrupts();
+    };
+
+    uint8_t getPending(void) // channels still waiting, an expired window keeps the old values
+    {
+        const bool expired = ((millis() - start) >= window);
+        noInterrupts();
+        if (expired) pending = 0;
+        const uint8_t value = pending;
+        interrupts();
+        return value;
+    };
+};
+
+template <>
+class SampleRequest<false> // without providers the setters keep pushing values
+{
+public:
+
+    bool    setProvider(const SampleProvider, void * const) { return false; };
+    bool    request(OneWireItem &, const uint8_t, const uint16_t) { return false; };
+    void    complete(const uint8_t) { };
+    uint8_t getPending(void) { return 0; };
+};
+
+
+// default-rules of the scratchpad-engine, the traits of a device derive from it and override what differs
+struct ScratchpadTraits
+{
+    static constexpr uint16_t TA_MASK       = 0xFFFF; // target address gets stripped to the address-space
+    static constexpr bool     READ_CRC      = false;  // read scratchpad ends at ES and is followed by an inverted crc16, otherwise it runs to the end without crc
+    static constexpr bool     COPY_ALIGNED  = false;  // copy writes the whole scratchpad to the aligned TA, otherwise only TA to ES
+    static constexpr bool     COPY_BUSY     = true;   // passive 1s while programming (eeprom), before the alternating 1 & 0
+    static constexpr bool     COPY_CLEARS   = false;  // scratchpad reads as zero after a copy
+    static constexpr uint8_t  COPY_CMD      = 0x55;   // command of the copy, recorded in the write-journal
+
+    template <typename device_t>
+    static void filterScratchpad(const device_t &, uint8_t [], const uint16_t, const uint8_t, const uint8_t) { }; // applied after write, gets TA and the written range
+    template <typename device_t>
+    static bool isCopyProtected(const device_t &, const uint16_t) { return false; };
+};
+
+// write- / read- / copy-scratchpad with TA- and ES-register, shared by the eeproms and rams of the ds24xx family
+// traits_t brings SIZE (power of two, fits the arena of the hub) and the rules above, the device calls the matching method from its duty()
+// the registers survive between transactions, the scratchpad itself is borrowed from the arena of the hub
+// hub_t is the OneWireHub of the duty(), scratchpad_check.cpp passes a scripted bus instead
+template <typename traits_t>
+class ScratchpadEngine
+{
+private:
+
+    static constexpr uint8_t  SIZE          = traits_t::SIZE;
+    static constexpr uint8_t  MASK          = SIZE - 1;
+
+    static constexpr uint8_t  REG_ES_PF_MASK    = 0b00100000; // partial byte flag
+    static constexpr uint8_t  REG_ES_AA_MASK    = 0b10000000; // authorization accepted (data copied to target memory)
+
+    uint16_t reg_TA; // contains TA1, TA2 (Target Address)
+    uint8_t  reg_ES; // E/S register
+
+    template <typename hub_t>
+    uint8_t * getScratchpad(hub_t * const hub, const OneWireItem &owner) // scratchpad of an earlier transaction, a lost one reads as zero and can't be copied
+    {
+        if (hub->ownsArena(owner)) return hub->claimArena(owner);
+
+        reg_ES |= REG_ES_PF_MASK; // a following copy has to fail
+        uint8_t * const scratchpad = hub->claimArena(owner);
+        memset(scratchpad, static_cast<uint8_t>(0x00), SIZE);
+        return scratchpad;
+    };
+
+public:
+
+    ScratchpadEngine(void) : reg_TA(0), reg_ES(0)
+    {
+        static_assert((SIZE & MASK) == 0, "Scratchpad-size must be a power of two");
+        static_assert(SIZE <= HUB_ARENA_SIZE, "Scratchpad does not fit into the arena of the hub");
+    };
+
+    uint16_t getTargetAddress(void) const { return reg_TA; };
+
+    // all return true if the transaction got interrupted, crc contains the received command
+    template <typename hub_t, typename device_t>
+    bool write(hub_t * const hub, device_t &device, uint16_t crc)
+    {
+        if (hub->recv(reinterpret_cast<uint8_t *>(&reg_TA),2,crc)) return true;
+        reg_TA &= traits_t::TA_MASK; // make sure to stay in boundary
+        reg_ES = uint8_t(reg_TA) & MASK; // register-offset
+
+        const uint8_t start = reg_ES;
+        const bool    taken = !hub->ownsArena(device);
+        uint8_t * const scratchpad = hub->claimArena(device);
+        if (taken) memset(scratchpad, static_cast<uint8_t>(0x00), SIZE); // bytes outside of the write would show the data of another slave (and get copied with COPY_ALIGNED)
+
+        for (; reg_ES < SIZE; ++reg_ES) // the master decides how much to send, a reset or pause ends it
+        {
+            if (hub->recv(&scratchpad[reg_ES], 1, crc))
+            {
+                if (hub->getError() == Error::AWAIT_TIMESLOT_TIMEOUT_HIGH) reg_ES |= REG_ES_PF_MASK;
+                break;
+            }
+        };
+        reg_ES--;
+        reg_ES &= MASK;
+
+        if (hub->getError() == Error::NO_ERROR)  // try to send crc if wanted
+        {
+            crc = ~crc; // normally crc16 is sent ~inverted
+            hub->send(reinterpret_cast<uint8_t *>(&crc), 2);
+        };
+
+        traits_t::filterScratchpad(device, scratchpad, reg_TA, start, reg_ES & MASK);
+        return hub->getError() != Error::NO_ERROR;
+    };
+
+    template <typename hub_t, typename device_t>
+    bool read(hub_t * const hub, device_t &device, uint16_t crc)
+    {
+        const uint8_t * const scratchpad = getScratchpad(hub, device); // can change reg_ES
+        const uint8_t start  = uint8_t(reg_TA) & MASK;
+        const uint8_t length = traits_t::READ_CRC ? uint8_t((reg_ES & MASK) + uint8_t(1) - start) : uint8_t(SIZE - start);
+
+        if (hub->send(reinterpret_cast<uint8_t *>(&reg_TA),2,crc))  return true;
+        if (hub->send(&reg_ES,1,crc))                               return true;
+        if (hub->send(&scratchpad[start],length,crc))               return true;
+        if (!traits_t::READ_CRC)                                    return false; // datasheet says we should send all 1s till reset, they are passive
+
+        crc = ~crc;
+        return hub->send(reinterpret_cast<uint8_t *>(&crc),2);
+    };
+
+    template <typename hub_t, typename device_t>
+    bool copy(hub_t * const hub, device_t &device)
+    {
+        constexpr uint8_t ALTERNATING_10 = 0xAA;
+        uint8_t data;
+
+        if (hub->recv(&data))                                   return true; // TA1
+        if (data != reinterpret_cast<uint8_t *>(&reg_TA)[0])    return false;
+        if (hub->recv(&data))                                   return true; // TA2
+        if (data != reinterpret_cast<uint8_t *>(&reg_TA)[1])    return false;
+        if (hub->recv(&data))                                   return true; // ES, auth code must match
+        if (data != reg_ES)                                     return false;
+
+        if (traits_t::isCopyProtected(device, reg_TA))          return false;
+        if (!hub->ownsArena(device))                            return false; // scratchpad was lost to another slave
+        if (reg_ES & REG_ES_PF_MASK)                            return false; // stop if error occured earlier
+
+        reg_ES |= REG_ES_AA_MASK; // compare was successful
+
+        {
+            uint8_t * const scratchpad = hub->claimArena(device);
+            if (traits_t::COPY_ALIGNED) reg_TA &= ~uint16_t(MASK);
+            const uint8_t start  = uint8_t(reg_TA) & MASK;
+            const uint8_t length = traits_t::COPY_ALIGNED ? SIZE : uint8_t((reg_ES & MASK) + uint8_t(1) - start);
+            device.writeMemory(&scratchpad[start], length, reg_TA); // device checks its own write-protection
+            hub->pushEvent(device, reg_TA, length, scratchpad[start]);
+            hub->pushJournal(device, traits_t::COPY_CMD, reg_TA, &scratchpad[start], length);
+            if (traits_t::COPY_CLEARS) memset(scratchpad, static_cast<uint8_t>(0x00), SIZE);
+        }
+
+        if (traits_t::COPY_BUSY)
+        {
+            do
+            {
+                hub->clearError();
+                hub->sendBit(true); // send passive 1s while "programming"
+            }
+            while   (hub->getError() == Error::AWAIT_TIMESLOT_TIMEOUT_HIGH); // wait for timeslots
+        };
+
+        while (!hub->send(&ALTERNATING_10)); // alternating 1 & 0 after copy is complete
+        return false;
+    };
 };
 
 
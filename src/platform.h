@@ -4,6 +4,7 @@
 #define ONEWIREHUB_PLATFORM_H
 
 // NOTE: added io_reg_t, don't use IO_REG_TYPE and IO_REG_ASM anymore
+// NOTE: DIRECT_WRITE_MASKED is optional, it writes several pins of one port at once (GPIO-debug-port of the hub)
 // Platform specific I/O definitions
 
 #if defined(__AVR__)
@@ -14,6 +15,7 @@
 #define DIRECT_MODE_OUTPUT(base, mask)  ((*((base)+1)) |= (mask))
 #define DIRECT_WRITE_LOW(base, mask)    ((*((base)+2)) &= ~(mask))
 #define DIRECT_WRITE_HIGH(base, mask)   ((*((base)+2)) |= (mask))
+#define DIRECT_WRITE_MASKED(base, mask, value)  ((*((base)+2)) = ((*((base)+2)) & ~(mask)) | (value))
 using io_reg_t = uint8_t; // define special datatype for register-access
 constexpr uint8_t VALUE_IPL {13}; // instructions per loop, compare 0 takes 11, compare 1 takes 13 cycles
 
@@ -36,6 +38,7 @@ constexpr uint8_t VALUE_IPL {8}; // instructions per loop
 #define DIRECT_MODE_OUTPUT(base, mask)  (*((base)+20) |= (mask))
 #define DIRECT_WRITE_LOW(base, mask)    (*((base)+8) = (mask))
 #define DIRECT_WRITE_HIGH(base, mask)   (*((base)+4) = (mask))
+#define DIRECT_WRITE_MASKED(base, mask, value)  (*(base) = (*(base) & ~(mask)) | (value))
 using io_reg_t = uint8_t; // define special datatype for register-access
 constexpr uint8_t VALUE_IPL {0}; // instructions per loop, uncalibrated so far - see ./examples/debug/calibrate_by_bus_timing for an explanation
 
@@ -51,6 +54,7 @@ constexpr uint8_t VALUE_IPL {0}; // instructions per loop, uncalibrated so far -
 #define DIRECT_MODE_OUTPUT(base, mask)  ((*((base)+4)) = (mask))
 #define DIRECT_WRITE_LOW(base, mask)    ((*((base)+13)) = (mask))
 #define DIRECT_WRITE_HIGH(base, mask)   ((*((base)+12)) = (mask))
+#define DIRECT_WRITE_MASKED(base, mask, value)  ((*((base)+12)) = (value), (*((base)+13)) = (mask) & ~(value)) // set & clear, ODSR would need OWER
 #ifndef PROGMEM
 #define PROGMEM
 #endif
@@ -68,6 +72,7 @@ constexpr uint8_t VALUE_IPL {0}; // instructions per loop, uncalibrated so far -
 #define DIRECT_MODE_OUTPUT(base, mask)  ((*(base+1)) = (mask))            //TRISXCLR + 0x04
 #define DIRECT_WRITE_LOW(base, mask)    ((*(base+8+1)) = (mask))          //LATXCLR  + 0x24
 #define DIRECT_WRITE_HIGH(base, mask)   ((*(base+8+2)) = (mask))          //LATXSET + 0x28
+#define DIRECT_WRITE_MASKED(base, mask, value)  ((*(base+8)) = ((*(base+8)) & ~(mask)) | (value)) //LATX + 0x20
 using io_reg_t = uint32_t; // define special datatype for register-access
 constexpr uint8_t VALUE_IPL {0}; // instructions per loop, uncalibrated so far - see ./examples/debug/calibrate_by_bus_timing for an explanation
 
@@ -79,6 +84,7 @@ constexpr uint8_t VALUE_IPL {0}; // instructions per loop, uncalibrated so far -
 #define DIRECT_MODE_OUTPUT(base, mask)  (GPE |= (mask))             //GPIO_ENABLE_W1TS_ADDRESS
 #define DIRECT_WRITE_LOW(base, mask)    (GPOC = (mask))             //GPIO_OUT_W1TC_ADDRESS
 #define DIRECT_WRITE_HIGH(base, mask)   (GPOS = (mask))             //GPIO_OUT_W1TS_ADDRESS
+#define DIRECT_WRITE_MASKED(base, mask, value)  (GPO = (GPO & ~(mask)) | (value)) //GPIO_OUT_ADDRESS
 using io_reg_t = uint32_t; // define special datatype for register-access
 constexpr uint8_t VALUE_IPL {0}; // instructions per loop, uncalibrated so far - see ./examples/debug/calibrate_by_bus_timing for an explanation
 
@@ -90,6 +96,7 @@ constexpr uint8_t VALUE_IPL {0}; // instructions per loop, uncalibrated so far -
 #define DIRECT_MODE_OUTPUT(base, mask)  ((*((base)+2)) = (mask))
 #define DIRECT_WRITE_LOW(base, mask)    ((*((base)+5)) = (mask))
 #define DIRECT_WRITE_HIGH(base, mask)   ((*((base)+6)) = (mask))
+#define DIRECT_WRITE_MASKED(base, mask, value)  ((*((base)+4)) = ((*((base)+4)) & ~(mask)) | (value))
 using io_reg_t = uint32_t; // define special datatype for register-access
 constexpr uint8_t VALUE_IPL {0}; // instructions per loop, uncalibrated so far - see ./examples/debug/calibrate_by_bus_timing for an explanation
 
@@ -211,6 +218,8 @@ constexpr uint8_t VALUE_IPL {1}; // instructions per loop, uncalibrated so far -
 
 #define ARDUINO_attiny // to load up Serial below
 
+#include <chrono>
+
 template <typename T1>
 uint8_t digitalRead(T1) {return 0;};
 
@@ -220,20 +229,30 @@ uint8_t digitalWrite(T1, T2) {return 0;};
 template <typename T1, typename T2>
 uint8_t pinMode(T1, T2) {return 0;};
 
-uint8_t digitalPinToPort(uint8_t x) {return 0;};
-uint8_t *portInputRegister(uint8_t x) {return 0;};
-uint8_t digitalPinToBitMask(uint8_t x) {return 0;};
+inline uint8_t digitalPinToPort(uint8_t) {return 0;};
+inline uint8_t *portInputRegister(uint8_t) {return 0;};
+inline uint8_t digitalPinToBitMask(uint8_t) {return 0;};
 
-constexpr uint32_t microsecondsToClockCycles(uint32_t x) {return 100;}; // mockup, emulate 100 MHz CPU
+constexpr uint32_t microsecondsToClockCycles(uint32_t) {return 100;}; // mockup, emulate 100 MHz CPU
 
-void delayMicroseconds(...) {};
-uint32_t micros(void) {return 0;}; // takes about 3 µs to process @ 16 MHz
+inline void delayMicroseconds(...) {};
 
-void cli(void) {};
-void sei(void) {};
+// the mockup uses the monotonic clock of the host, so timing-measurements are real
+inline uint32_t micros(void)
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+};
 
-void noInterrupts(void) {};
-void interrupts(void) {};
+inline uint32_t millis(void)
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+};
+
+inline void cli(void) {};
+inline void sei(void) {};
+
+inline void noInterrupts(void) {};
+inline void interrupts(void) {};
 
 #endif
 
@@ -244,7 +263,7 @@ void interrupts(void) {};
 
 #define HEX 1
 
-class
+static class
 {
 public:
 
@@ -253,17 +272,16 @@ public:
     void println(...) {};
 
     void flush(void) {};
-    void begin(uint32_t x) {};
+    void begin(uint32_t) {};
 
-} Serial;
+} Serial __attribute__((unused)); // not every translation unit prints
 
-template <typename T1, typename T2>
-void memset(T1 address[], T1 initValue[], T2 size)
+template <typename T1, typename T2, typename T3>
+void memset(T1 address[], const T2 initValue, const T3 size) // works for byte-arrays only, like the other FN here
 {
-    size = size / sizeof(T2);
-    for (T2 counter = 0; counter < size; ++counter)
+    for (T3 counter = 0; counter < size; ++counter)
     {
-        address[counter] = (initValue);
+        address[counter] = static_cast<T1>(initValue);
     }
 };
 
@@ -294,4 +312,114 @@ void        wdt_enable(...);
 
 #endif
 
+// tables in flash (CRC-kernels), platforms without separate address space read them directly
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#endif
+#ifndef pgm_read_word
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#endif
+
+/////////////////////////////////////////// CYCLE COUNTER //////////////////////////////////////
+// cycleCount() returns the cpu-cycles since an arbitrary point in time and wraps around
+// it is used by the probes of the hub (PROBE_ENABLE in config) to measure hot paths the same way on every platform
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+using cycle_t = uint32_t;
+
+#if defined(__AVR__)
+// timer0 runs with prescaler 64 for millis(), so the resolution is 64 cycles, this is micros() without the division
+extern volatile unsigned long timer0_overflow_count;
+
+static inline __attribute__((always_inline))
+void cycleCountInit(void) {};
+
+static inline __attribute__((always_inline))
+cycle_t cycleCount(void)
+{
+    const uint8_t sreg = SREG;
+    cli();
+    cycle_t overflows = timer0_overflow_count;
+    const uint8_t count = TCNT0;
+#if defined(TIFR0)
+    if ((TIFR0 & _BV(TOV0)) && (count < 255)) overflows++;
+#else
+    if ((TIFR & _BV(TOV0)) && (count < 255)) overflows++;
+#endif
+    SREG = sreg;
+    return ((overflows << 8) + count) << 6;
+};
+
+#elif defined(__MK20DX128__) || defined(__MK20DX256__) || defined(__MK66FX1M0__) || defined(__MK64FX512__) || defined(__SAM3X8E__)
+// cortex M3/M4 offer the DWT cycle counter, it has to be enabled once
+#define CYCCNT_REG_DEMCR                (*(volatile uint32_t *)0xE000EDFC)
+#define CYCCNT_REG_DWT_CTRL             (*(volatile uint32_t *)0xE0001000)
+#define CYCCNT_REG_DWT_CYCCNT           (*(volatile uint32_t *)0xE0001004)
+
+static inline __attribute__((always_inline))
+void cycleCountInit(void)
+{
+    CYCCNT_REG_DEMCR    |= (1UL << 24); // TRCENA
+    CYCCNT_REG_DWT_CTRL |= (1UL << 0);  // CYCCNTENA
+};
+
+static inline __attribute__((always_inline))
+cycle_t cycleCount(void)
+{
+    return CYCCNT_REG_DWT_CYCCNT;
+};
+
+#elif defined(ARDUINO_ARCH_ESP8266)
+static inline __attribute__((always_inline))
+void cycleCountInit(void) {};
+
+static inline __attribute__((always_inline))
+cycle_t cycleCount(void)
+{
+    cycle_t ccount;
+    __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+    return ccount;
+};
+
+#elif !defined(ARDUINO) && (defined(__x86_64__) || defined(__i386__))
+// host-mockup: the timestamp counter runs with the nominal clock of the cpu, not with the emulated 100 MHz
+#include <x86intrin.h>
+
+static inline __attribute__((always_inline))
+void cycleCountInit(void) {};
+
+static inline __attribute__((always_inline))
+cycle_t cycleCount(void)
+{
+    return static_cast<cycle_t>(__rdtsc());
+};
+
+#elif !defined(ARDUINO)
+// host-mockup without rdtsc: convert the monotonic clock into cycles of the emulated cpu
+static inline __attribute__((always_inline))
+void cycleCountInit(void) {};
+
+static inline __attribute__((always_inline))
+cycle_t cycleCount(void)
+{
+    const auto time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    return static_cast<cycle_t>(time_ns * microsecondsToClockCycles(1) / 1000);
+};
+
+#else
+// fallback: cortex M0+ (teensyLC, arduino zero) and the rest offer no cycle counter, so the resolution is 1 µs
+static inline __attribute__((always_inline))
+void cycleCountInit(void) {};
+
+static inline __attribute__((always_inline))
+cycle_t cycleCount(void)
+{
+    return static_cast<cycle_t>(micros() * microsecondsToClockCycles(1));
+};
+
+#endif
+
 #endif //ONEWIREHUB_PLATFORM_H